@@ -0,0 +1,81 @@
+#ifndef CQColorAsyncPreview_H
+#define CQColorAsyncPreview_H
+
+#include <QObject>
+#include <QColor>
+#include <QVariant>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+// Debounced asynchronous preview of colors.
+//
+// Expensive consumers of color changes supply a function which is run on a worker
+// thread with the latest requested color. Requests made while the worker is busy
+// supersede each other (only the latest is run) and a running function can poll
+// Request::isCancelled() to stop early when a newer color arrives. Results are
+// delivered on the GUI thread with resultReady() (results of superseded requests
+// are dropped). An optional debounce delay waits for requests to settle first.
+class CQColorAsyncPreview : public QObject {
+  Q_OBJECT
+
+ public:
+  class Request {
+   public:
+    Request(const QColor &c, uint generation, const std::atomic<uint> &current) :
+     c_(c), generation_(generation), current_(current) {
+    }
+
+    const QColor &color() const { return c_; }
+
+    //! true if newer request made (result will be dropped)
+    bool isCancelled() const { return current_ != generation_; }
+
+   private:
+    QColor                   c_;
+    uint                     generation_ { 0 };
+    const std::atomic<uint> &current_;
+  };
+
+  using Func = std::function<QVariant (const Request &request)>;
+
+ public:
+  CQColorAsyncPreview(const Func &func, int debounce=0, QObject *parent=nullptr);
+ ~CQColorAsyncPreview();
+
+  //! get/set debounce delay (ms)
+  int debounce() const { return debounce_; }
+  void setDebounce(int ms) { debounce_ = ms; }
+
+  //! request preview of color (supersedes any pending or running request)
+  void request(const QColor &c);
+
+  //! get number of requests, function runs and delivered results
+  int numRequests() const { return numRequests_; }
+  int numRuns    () const { return numRuns_; }
+  int numResults () const { return numResults_; }
+
+ signals:
+  void resultReady(const QColor &c, const QVariant &result);
+
+ private:
+  void run();
+
+ private:
+  Func                    func_;
+  std::atomic<int>        debounce_    { 0 };
+  std::thread             thread_;
+  std::mutex              mutex_;
+  std::condition_variable cond_;
+  QColor                  pending_;
+  bool                    hasPending_  { false };
+  bool                    stop_        { false };
+  std::atomic<uint>       generation_  { 0 };
+  int                     numRequests_ { 0 };
+  std::atomic<int>        numRuns_     { 0 };
+  int                     numResults_  { 0 };
+};
+
+#endif
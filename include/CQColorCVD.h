@@ -0,0 +1,33 @@
+#ifndef CQColorCVD_H
+#define CQColorCVD_H
+
+#include <QColor>
+#include <QImage>
+
+// Color vision deficiency simulation.
+//
+// Uses the Machado et al. (2009) matrices for full severity dichromacy applied in
+// linear RGB. Pixels are converted to linear RGB with lookup tables and the 3x3
+// matrix is applied to whole rows as separate float channel arrays so the inner
+// loop has no per pixel branches.
+namespace CQColorCVD {
+
+enum class Type {
+  NONE,
+  PROTAN,
+  DEUTAN,
+  TRITAN
+};
+
+// simulate single color (alpha unchanged)
+QColor simulate(const QColor &c, Type type);
+
+// simulate row of pixels in place (alpha unchanged)
+void simulateRow(QRgb *pixels, int n, Type type, bool premultiplied=false);
+
+// simulate image in place (32 bit formats, others are converted to ARGB32)
+void simulateImage(QImage &image, Type type);
+
+}
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef CQColorContrast_H
+#define CQColorContrast_H
+
+#include <QColor>
+
+// Color contrast functions
+namespace CQColorContrast {
+
+// WCAG 2.x relative luminance (0-1)
+double luminance(const QColor &c);
+double luminance(QRgb rgb);
+
+// WCAG 2.x contrast ratio (1-21) from luminances or colors
+double contrastRatio(double l1, double l2);
+double contrastRatio(const QColor &c1, const QColor &c2);
+
+// APCA (W3 0.0.98G) lightness contrast (Lc) of text on background
+double apca(const QColor &text, const QColor &bg);
+
+// WCAG contrast ratio thresholds (3, 4.5 and 7)
+int    numThresholds();
+double threshold(int i);
+
+// number of thresholds met by contrast ratio (0-3)
+int level(double ratio);
+
+}
+
+#endif
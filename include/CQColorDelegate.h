@@ -0,0 +1,61 @@
+#ifndef CQColorDelegate_H
+#define CQColorDelegate_H
+
+#include <CQColorSelector.h>
+#include <QStyledItemDelegate>
+
+// Item delegate for color cells.
+//
+// Cells are painted directly (swatch or channel gradient) with the same drawing
+// code as CQColorButton and CQColorGradient so no widgets are created per cell.
+// A CQColorSelector editor is only acquired (from CQColorSelectorPool) while a
+// cell is being edited and is returned to the pool when editing ends.
+class CQColorDelegate : public QStyledItemDelegate {
+  Q_OBJECT
+
+ public:
+  typedef CQColorSelector::ColorType ColorType;
+
+  enum class Style {
+    SWATCH,
+    GRADIENT
+  };
+
+ public:
+  CQColorDelegate(QObject *parent=nullptr);
+
+  //! get/set item data role holding color
+  int role() const { return role_; }
+  void setRole(int role) { role_ = role; }
+
+  //! get/set cell style
+  Style style() const { return style_; }
+  void setStyle(Style style) { style_ = style; }
+
+  //! get/set gradient channel (for GRADIENT style)
+  ColorType gradientType() const { return gradientType_; }
+  void setGradientType(ColorType type) { gradientType_ = type; }
+
+  void paint(QPainter *painter, const QStyleOptionViewItem &option,
+             const QModelIndex &index) const override;
+
+  QWidget *createEditor(QWidget *parent, const QStyleOptionViewItem &option,
+                        const QModelIndex &index) const override;
+
+  void destroyEditor(QWidget *editor, const QModelIndex &index) const override;
+
+  void setEditorData(QWidget *editor, const QModelIndex &index) const override;
+
+  void setModelData(QWidget *editor, QAbstractItemModel *model,
+                    const QModelIndex &index) const override;
+
+  void updateEditorGeometry(QWidget *editor, const QStyleOptionViewItem &option,
+                            const QModelIndex &index) const override;
+
+ private:
+  int       role_         { Qt::EditRole };
+  Style     style_        { Style::SWATCH };
+  ColorType gradientType_ { ColorType::HSL_L };
+};
+
+#endif
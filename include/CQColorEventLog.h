@@ -0,0 +1,121 @@
+#ifndef CQColorEventLog_H
+#define CQColorEventLog_H
+
+#include <CQColorSelector.h>
+#include <QObject>
+#include <QElapsedTimer>
+#include <QPointF>
+#include <vector>
+
+// Recorded mouse/tablet input of a selector's gradients and wheel.
+//
+// Events are stored relative to their target (gradient channel type or wheel) with
+// positions normalized to the target size, so a log can be replayed against another
+// selector instance (e.g. offscreen) of a different size. The binary file is a small
+// header (selector mode and start color) followed by 14 byte event records
+// (microsecond time delta, event type, target, buttons, position and pressure).
+class CQColorEventLog {
+ public:
+  enum class Type {
+    MOUSE_PRESS,
+    MOUSE_MOVE,
+    MOUSE_RELEASE,
+    TABLET_PRESS,
+    TABLET_MOVE,
+    TABLET_RELEASE
+  };
+
+  enum class Target {
+    GRADIENT,
+    WHEEL
+  };
+
+  struct Event {
+    qint64                     time     { 0 };   // microseconds since start
+    Type                       type     { Type::MOUSE_MOVE };
+    Target                     target   { Target::GRADIENT };
+    CQColorSelector::ColorType channel  { CQColorSelector::ColorType::RGB_R };
+    Qt::MouseButton            button   { Qt::NoButton };
+    Qt::MouseButtons           buttons  { Qt::NoButton };
+    QPointF                    pos;               // normalized (0-1) position
+    double                     pressure { 0.0 };
+  };
+
+  using Events = std::vector<Event>;
+
+  enum class Speed {
+    ORIGINAL, // events sent at recorded times
+    MAX       // events sent as soon as previous is processed
+  };
+
+  // frame (event processing and repaint) time stats of replay
+  struct FrameStats {
+    int                 numEvents  { 0 };
+    int                 numSkipped { 0 }; // no visible target
+    double              totalMs    { 0.0 };
+    double              meanMs     { 0.0 };
+    double              maxMs      { 0.0 };
+    std::vector<double> times;            // per event (ms)
+    std::vector<int>    histogram;        // counts per histogramLimits() bucket
+  };
+
+ public:
+  CQColorEventLog() { }
+
+  //! get/set selector mode and color at start of log
+  CQColorSelector::ColorMode mode() const { return mode_; }
+  void setMode(CQColorSelector::ColorMode mode) { mode_ = mode; }
+
+  const QColor &color() const { return color_; }
+  void setColor(const QColor &c) { color_ = c; }
+
+  const Events &events() const { return events_; }
+
+  void addEvent(const Event &event) { events_.push_back(event); }
+
+  void clear() { events_.clear(); }
+
+  //! read/write binary log file
+  bool load(const QString &filename);
+  bool save(const QString &filename) const;
+
+  //! replay events against selector (sets log mode and color first)
+  FrameStats replay(CQColorSelector *selector, Speed speed=Speed::ORIGINAL) const;
+
+  //! get frame time histogram bucket upper limits (ms, last is unbounded)
+  static const std::vector<double> &histogramLimits();
+
+ private:
+  CQColorSelector::ColorMode mode_  { CQColorSelector::ColorMode::RGB };
+  QColor                     color_;
+  Events                     events_;
+};
+
+//---
+
+// Records input events of a selector's gradients and wheel to an event log
+// (application event filter).
+class CQColorEventRecorder : public QObject {
+ public:
+  CQColorEventRecorder(QObject *parent=nullptr);
+ ~CQColorEventRecorder();
+
+  //! start recording input to selector (clears log)
+  void start(CQColorSelector *selector);
+
+  //! stop recording
+  void stop();
+
+  bool isRecording() const { return selector_ != nullptr; }
+
+  const CQColorEventLog &log() const { return log_; }
+
+  bool eventFilter(QObject *obj, QEvent *e) override;
+
+ private:
+  CQColorSelector *selector_ { nullptr };
+  CQColorEventLog  log_;
+  QElapsedTimer    timer_;
+};
+
+#endif
@@ -0,0 +1,95 @@
+#ifndef CQColorEyedropper_H
+#define CQColorEyedropper_H
+
+#include <QWidget>
+#include <QImage>
+
+class QTimer;
+
+// Screen color picker.
+//
+// Only a small region (2*radius + 1 square) around the cursor is captured and the
+// captures are throttled to the screen refresh rate. The loupe is drawn from the
+// last captured region so repaints never touch the screen.
+//
+// A synthetic screen image can be set (setScreenImage) to replace screen grabs,
+// e.g. when running on the offscreen or xvfb platforms.
+class CQColorEyedropper : public QWidget {
+  Q_OBJECT
+
+ public:
+  CQColorEyedropper(QWidget *parent=nullptr);
+
+  //! get/set capture radius (pixels around cursor)
+  int radius() const { return radius_; }
+  void setRadius(int r);
+
+  //! get/set loupe zoom factor
+  int zoom() const { return zoom_; }
+  void setZoom(int z);
+
+  //! get current (hovered) color
+  const QColor &color() const { return color_; }
+
+  //! get last captured region
+  const QImage &region() const { return region_; }
+
+  //! get number of region captures (for throttle checking)
+  int numCaptures() const { return numCaptures_; }
+
+  //! start/stop picking
+  void start();
+  void stop();
+
+  bool isActive() const { return active_; }
+
+  //! move cursor position (global coords). Capture happens on next frame
+  void setCursorPos(const QPoint &pos);
+
+  //! capture region at global position and return center color
+  QColor pickAt(const QPoint &pos);
+
+  //! get/set synthetic screen image (null image to use real screen)
+  static const QImage &screenImage();
+  static void setScreenImage(const QImage &image);
+
+  QSize sizeHint() const override;
+
+ signals:
+  void colorHovered(const QColor &c);
+  void colorPicked(const QColor &c);
+  void canceled();
+
+ protected:
+  void paintEvent(QPaintEvent *) override;
+
+  void mousePressEvent(QMouseEvent *e) override;
+  void mouseMoveEvent (QMouseEvent *e) override;
+
+  void keyPressEvent(QKeyEvent *e) override;
+
+ private slots:
+  void captureSlot();
+
+ private:
+  void captureRegion(const QPoint &pos);
+
+  QImage grabRegion(const QRect &rect) const;
+
+  void updateTimer();
+  void placeLoupe();
+
+ private:
+  QTimer *timer_       { nullptr };
+  int     radius_      { 7 };
+  int     zoom_        { 9 };
+  bool    active_      { false };
+  bool    dirty_       { false };
+  QPoint  pos_;
+  QPoint  capturePos_;
+  QImage  region_;
+  QColor  color_;
+  int     numCaptures_ { 0 };
+};
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef CQColorHSL_H
+#define CQColorHSL_H
+
+#include <QColor>
+
+// Fast HSL to RGB conversion.
+//
+// Uses the separable form of HSL: rgb = l + c*(hue(h) - 0.5) where
+// c = (1 - |2l - 1|)*s and hue(h) is the fully saturated color of the hue.
+// hue(h) is read from a table (built lazily, once) so each conversion is a table
+// lookup plus a multiply-add per channel instead of the sextant logic in
+// QColor::fromHslF. The table has 1024 entries per sextant so results are within
+// one 8 bit unit of QColor.
+namespace CQColorHSL {
+
+// get/set table conversion enabled (when disabled QColor::fromHslF is used)
+bool isEnabled();
+void setEnabled(bool b);
+
+// convert hsl (0-1, h < 0 for achromatic) to rgb
+QRgb toRgb(double h, double s, double l, int alpha=255);
+
+}
+
+#endif
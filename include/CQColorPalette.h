@@ -0,0 +1,105 @@
+#ifndef CQColorPalette_H
+#define CQColorPalette_H
+
+#include <QColor>
+#include <QImage>
+#include <vector>
+#include <cstdint>
+
+// Image palette functions
+namespace CQColorPalette {
+
+using Colors = std::vector<QColor>;
+
+enum class Distance {
+  RGB,       // euclidean distance in sRGB
+  PERCEPTUAL // euclidean distance in CIE Lab (D65)
+};
+
+struct MapOptions {
+  MapOptions() { }
+
+  Distance distance   { Distance::RGB };
+  bool     dither     { false }; // Floyd-Steinberg error diffusion
+  int      numThreads { 0 };     // <= 0 for all cores
+};
+
+// Nearest palette color search.
+//
+// Palette colors are stored in a kd-tree in the distance space so each search
+// only visits a few nodes. Searches are const (thread safe), callers are
+// expected to keep their own Cache of recent lookups.
+class NearestColor {
+ public:
+  // direct mapped cache of recent rgb -> index lookups (one per thread)
+  class Cache {
+   public:
+    Cache();
+
+   private:
+    friend class NearestColor;
+
+    static const int SIZE = 4096;
+
+    std::vector<uint32_t> keys_;
+    std::vector<int>      inds_;
+  };
+
+ public:
+  NearestColor(const Colors &palette, Distance distance=Distance::RGB);
+
+  int numColors() const { return int(rgbs_.size()); }
+
+  QRgb rgb(int i) const { return rgbs_[i]; }
+
+  // get index of nearest palette color (-1 if empty palette)
+  int nearest(QRgb rgb) const;
+  int nearest(QRgb rgb, Cache &cache) const;
+
+ private:
+  struct Point {
+    float p[3];
+    int   ind;
+  };
+
+  struct Node {
+    Point pt;
+    int   axis  { 0 };
+    int   left  { -1 };
+    int   right { -1 };
+  };
+
+  void toPoint(QRgb rgb, float p[3]) const;
+
+  int build(std::vector<Point> &points, int start, int end, int depth);
+
+  void search(int node, const float q[3], int &best, float &bestD) const;
+
+ private:
+  Distance          distance_ { Distance::RGB };
+  std::vector<QRgb> rgbs_;
+  std::vector<Node> nodes_;
+  int               root_     { -1 };
+};
+
+// Extract n dominant colors from image (most common first).
+//
+// The image is sampled into a 15 bit (5 bits per channel) histogram in parallel
+// (numThreads <= 0 uses all cores), with the sample step chosen so at most maxSamples
+// pixels are read, and the histogram is reduced with median cut. Pixels with
+// alpha < 128 are ignored.
+Colors dominantColors(const QImage &image, int n, int numThreads=0, int maxSamples=1<<21);
+
+// Map image pixels to the nearest palette color.
+//
+// Scanlines are processed in parallel bands (each thread with its own lookup cache)
+// except when dithering, where the error diffusion is sequential from top to bottom.
+// Source alpha is preserved.
+QImage mapImage(const QImage &image, const Colors &palette, const MapOptions &options=MapOptions());
+
+// Get number of threads to use for requested number (<= 0 for all cores)
+int numThreads(int n);
+
+}
+
+#endif
@@ -0,0 +1,100 @@
+#ifndef CQColorRenderCache_H
+#define CQColorRenderCache_H
+
+#include <QImage>
+#include <functional>
+#include <unordered_map>
+#include <list>
+#include <mutex>
+#include <cstdint>
+
+// Process-wide cache of rendered images (gradient strips, wheel layers, checkerboards).
+//
+// Images are keyed by kind, size, device pixel ratio and the color components the
+// rendering depends on, so selectors showing the same thing share pixels. Entries
+// are evicted least recently used first when the total size exceeds the byte budget.
+// Returned images are implicitly shared (reference counted) so evicted images stay
+// valid for holders. Lookups are thread safe, rendering is done outside the lock.
+class CQColorRenderCache {
+ public:
+  enum class Kind {
+    GRADIENT_STRIP,
+    WHEEL_RING,
+    WHEEL_TRIANGLE,
+    CHECKERBOARD
+  };
+
+  struct Key {
+    Key() { }
+
+    Key(Kind kind, const QSize &size, double dpr, uint64_t components) :
+     kind(kind), size(size), dpr(dpr), components(components) {
+    }
+
+    bool operator==(const Key &key) const {
+      return (kind == key.kind && size == key.size && dpr == key.dpr &&
+              components == key.components);
+    }
+
+    Kind     kind       { Kind::GRADIENT_STRIP };
+    QSize    size;
+    double   dpr        { 1.0 };
+    uint64_t components { 0 };
+  };
+
+  struct Stats {
+    int64_t hits      { 0 };
+    int64_t misses    { 0 };
+    int64_t evictions { 0 };
+    int64_t bytes     { 0 }; // resident bytes
+    int     count     { 0 }; // resident images
+
+    double hitRate() const {
+      return (hits + misses > 0 ? double(hits)/double(hits + misses) : 0.0); }
+  };
+
+  using RenderFunc = std::function<QImage ()>;
+
+ public:
+  static CQColorRenderCache *instance();
+
+  //! get/set byte budget
+  int64_t budget() const;
+  void setBudget(int64_t bytes);
+
+  //! get cached image for key (rendered with func and added on miss)
+  QImage image(const Key &key, const RenderFunc &func);
+
+  //! remove all images
+  void clear();
+
+  //! get/reset stats
+  Stats stats() const;
+  void resetStats();
+
+ private:
+  CQColorRenderCache();
+
+  struct KeyHash {
+    size_t operator()(const Key &key) const;
+  };
+
+  struct Entry {
+    Key    key;
+    QImage image;
+  };
+
+  using Entries = std::list<Entry>;
+  using Index   = std::unordered_map<Key, Entries::iterator, KeyHash>;
+
+  void evict();
+
+ private:
+  mutable std::mutex mutex_;
+  int64_t            budget_ { 32*1024*1024 };
+  Entries            entries_; // most recently used first
+  Index              index_;
+  Stats              stats_;
+};
+
+#endif
@@ -0,0 +1,24 @@
+#ifndef CQColorSRGB_H
+#define CQColorSRGB_H
+
+// sRGB transfer function (IEC 61966-2-1).
+//
+// Conversion of sRGB components (0-1) to linear light and back, plus tables for
+// 8 bit components (built lazily, once). WCAG 2.x relative luminance uses the older
+// 0.03928 linear segment threshold so has its own (explicit) variant.
+namespace CQColorSRGB {
+
+// sRGB component (0-1) to linear and linear to sRGB
+double toLinear  (double c);
+double fromLinear(double c);
+
+// sRGB component (0-1) to linear with WCAG 2.x threshold (0.03928)
+double toLinearWCAG(double c);
+
+// get 256 entry tables of 8 bit sRGB component to linear (standard and WCAG)
+const float  *toLinearTable();
+const double *toLinearWCAGTable();
+
+}
+
+#endif
@@ -3,14 +3,65 @@
 
 #include <QSpinBox>
 #include <QLineEdit>
+#include <CQColorCVD.h>
+#include <CQColorAsyncPreview.h>
 #include <QToolButton>
+#include <QImage>
+#include <QElapsedTimer>
+#include <functional>
+#include <vector>
+
+class QTimer;
 
 class CQColorSpin;
 class CQColorButton;
 class CQColorEdit;
 class CQColorGradient;
+class CQColorChannelPanel;
 class CQColorSelectorWheel;
+class CQColorEyedropper;
+class CQColorSwatches;
+class CQColorImagePreview;
 class QTabWidget;
+class QLabel;
+
+//-----
+
+// Undo history of colors.
+//
+// Colors are stored packed (QRgb) in a fixed size ring buffer so memory is bounded,
+// the oldest entries are dropped when full.
+class CQColorHistory {
+ public:
+  CQColorHistory(int capacity=256);
+
+  int capacity() const { return int(rgbs_.size()); }
+
+  int size() const { return size_; }
+
+  //! reset to single color
+  void clear(QRgb rgb);
+
+  //! add color after current (removes redo colors), returns false if same as current
+  bool push(QRgb rgb);
+
+  bool canUndo() const { return pos_ > 0; }
+  bool canRedo() const { return pos_ >= 0 && pos_ < size_ - 1; }
+
+  QRgb current() const { return at(pos_); }
+
+  QRgb undo();
+  QRgb redo();
+
+ private:
+  QRgb at(int i) const { return rgbs_[(start_ + i) % capacity()]; }
+
+ private:
+  std::vector<QRgb> rgbs_;
+  int               start_ { 0 };
+  int               size_  { 0 };
+  int               pos_   { -1 };
+};
 
 //-----
 
@@ -27,6 +78,15 @@ class CQColorSelector : public QWidget {
     WHEEL
   };
 
+  enum class HarmonyMode {
+    NONE,
+    COMPLEMENTARY,
+    TRIAD,
+    ANALOGOUS,
+    SPLIT_COMPLEMENTARY,
+    TETRAD
+  };
+
   enum class ColorType {
     RGB_R,
     RGB_G,
@@ -41,6 +101,21 @@ class CQColorSelector : public QWidget {
     ALPHA
   };
 
+  // changed color components (bitmask)
+  enum Component : uint {
+    RED        = (1<<0),
+    GREEN      = (1<<1),
+    BLUE       = (1<<2),
+    HUE        = (1<<3),
+    SATURATION = (1<<4),
+    LIGHTNESS  = (1<<5),
+    CYAN       = (1<<6),
+    MAGENTA    = (1<<7),
+    YELLOW     = (1<<8),
+    BLACK      = (1<<9),
+    ALPHA      = (1<<10)
+  };
+
  public:
   struct Config {
     Config() { }
@@ -52,32 +127,175 @@ class CQColorSelector : public QWidget {
     bool alpha       { true };
     bool colorButton { true };
     bool colorEdit   { true };
+    bool eyedropper  { true };
+    bool palette     { true };
+    bool compact     { false }; // channel tabs drawn by single widget
   };
 
+  using Colors = std::vector<QColor>;
+
  public:
   CQColorSelector(QWidget *parent=nullptr, const Config &config=Config());
 
   const QColor &color() const { return c_; }
 
+  //! get/set current mode (shown tab). Returns false if no tab for mode
+  ColorMode mode() const { return mode_; }
+  bool setMode(ColorMode mode);
+
+  //! get/set palette colors (shown as swatches)
+  const Colors &paletteColors() const { return paletteColors_; }
+  void setPaletteColors(const Colors &colors);
+
+  //! set palette colors to n dominant colors of image
+  void extractPalette(const QImage &image, int n=8);
+
+  //! get/set preview image (shown mapped to palette colors)
+  const QImage &previewImage() const;
+  void setPreviewImage(const QImage &image);
+
+  //! get/set preview uses dithering
+  bool isPreviewDither() const;
+  void setPreviewDither(bool b);
+
+  //! get/set harmony mode (extra colors shown on wheel)
+  HarmonyMode harmonyMode() const { return harmonyMode_; }
+  void setHarmonyMode(HarmonyMode mode);
+
+  //! get/set harmony spread (hue offset for analogous and split complementary)
+  double harmonySpread() const { return harmonySpread_; }
+  void setHarmonySpread(double r);
+
+  //! get harmony hues (first is current color hue)
+  std::vector<double> harmonyHues() const;
+
+  //! get harmony colors (first is current color)
+  Colors harmonyColors() const;
+
+  //! drag harmony hue i to hue
+  void dragHarmony(int i, double hue);
+
+  //! get/set color vision deficiency simulation for all renderings
+  CQColorCVD::Type cvdType() const { return cvdType_; }
+  void setCvdType(CQColorCVD::Type type);
+
+  //! get color as displayed (with color vision deficiency simulation)
+  QColor displayColor(const QColor &c) const;
+
+  //! get/set reference (background) color for contrast display (invalid for none).
+  //! Contrast threshold contours are drawn on gradients and wheel triangle
+  const QColor &referenceColor() const { return referenceColor_; }
+  void setReferenceColor(const QColor &c);
+
+  bool hasReferenceColor() const { return referenceColor_.isValid(); }
+
+  //! get WCAG contrast ratio and APCA contrast of color against reference color
+  double contrastRatio() const;
+  double apcaContrast() const;
+
+  //! set channel value (0-255)
   void setColorType(ColorType type, int v);
 
+  //! set channel value (0-1, sub 8 bit precision for tablet/sub-pixel input)
+  void setColorTypeF(ColorType type, double v);
+
+  //! set color from change to specified channels. When colors are bound (setColors)
+  //! the channel change is applied to all of them as a relative delta
+  void setColorChannels(const QColor &c, const std::vector<ColorType> &types);
+
+  //! get/set bound colors for batch editing (color is set to first color).
+  //! RGB, CMYK and hue changes are added, saturation, lightness and alpha
+  //! changes are scaled. Whole color changes (edit field, swatches, eyedropper,
+  //! undo and redo) are applied as an RGB and alpha change (setColor does not
+  //! change bound colors)
+  const Colors &colors() const { return batch_; }
+  void setColors(const Colors &colors);
+
+  void clearColors();
+
+  //! true while widgets are being updated from color
+  bool isUpdating() const { return updating_; }
+
+  //! begin/end interaction (drag or edit). Changes during an interaction are
+  //! merged into a single undo entry
+  void beginInteraction();
+  void endInteraction();
+
+  //! get undo history
+  const CQColorHistory &history() const { return history_; }
+
+  bool canUndo() const { return history_.canUndo(); }
+  bool canRedo() const { return history_.canRedo(); }
+
+  //! reset undo history to current color
+  void clearHistory();
+
+  //! reset per consumer state: async preview hook, interaction, bound colors,
+  //! harmony mode, color vision deficiency type, palette, preview image and
+  //! reference color
+  void resetState();
+
+  //! set function run on a worker thread with the latest color after each change
+  //! (stale requests are superseded, see CQColorAsyncPreview). Results are emitted
+  //! on the GUI thread with previewReady. Empty function removes the hook
+  void setAsyncPreview(const CQColorAsyncPreview::Func &func, int debounce=0);
+
   QSize sizeHint() const override;
 
  public slots:
   void setColor(const QColor &c);
 
+  void undo();
+  void redo();
+
  signals:
+  //! emitted when color changes (not emitted when set to same color)
   void colorChanged(const QColor &c);
 
+  //! changed components (Component bits) of color change
+  void componentsChanged(uint components);
+
+  void hueChanged(double hue);
+
+  void alphaChanged(int alpha);
+
+  void previewReady(const QColor &c, const QVariant &result);
+
+  void paletteChanged();
+
+  void harmonyColorsChanged(const CQColorSelector::Colors &colors);
+
+  void colorsChanged(const CQColorSelector::Colors &colors);
+
+  //! emitted when returned to pool (CQColorSelectorPool::release) before consumer
+  //! connections are removed, so helpers attached to selector (e.g. CQColorSync) drop it
+  void released();
+
  private slots:
+  void applyColorSlot(const QColor &c);
+
   void tabChanged(int i);
 
+  void eyedropperSlot();
+
+  void loadImageSlot();
+
  private:
+  void updateWidgets();
+
   QWidget *createRGBTab();
   QWidget *createHSLTab();
   QWidget *createCMYKTab();
   QWidget *createWheelTab();
 
+  using ChannelNames = std::vector<std::pair<QString, ColorType>>;
+
+  CQColorChannelPanel *createPanel(const QString &name, const ChannelNames &channels);
+
+  std::vector<CQColorGradient *> gradients() const;
+
+  std::vector<CQColorChannelPanel *> panels() const;
+
  private:
   struct RGBWidgets {
     CQColorGradient *rcanvas { 0 };
@@ -89,6 +307,8 @@ class CQColorSelector : public QWidget {
     CQColorSpin *gspin { 0 };
     CQColorSpin *bspin { 0 };
     CQColorSpin *aspin { 0 };
+
+    CQColorChannelPanel *panel { 0 };
   };
 
   struct HSLWidgets {
@@ -101,6 +321,8 @@ class CQColorSelector : public QWidget {
     CQColorSpin *sspin { 0 };
     CQColorSpin *lspin { 0 };
     CQColorSpin *aspin { 0 };
+
+    CQColorChannelPanel *panel { 0 };
   };
 
   struct CMYKWidgets {
@@ -115,12 +337,15 @@ class CQColorSelector : public QWidget {
     CQColorSpin *yspin { 0 };
     CQColorSpin *kspin { 0 };
     CQColorSpin *aspin { 0 };
+
+    CQColorChannelPanel *panel { 0 };
   };
 
   struct WheelWidgets {
     CQColorSelectorWheel *wheel   { 0 };
     CQColorGradient      *acanvas { 0 };
     CQColorSpin          *aspin   { 0 };
+    CQColorChannelPanel  *panel   { 0 };
   };
 
   QColor    c_;
@@ -136,6 +361,91 @@ class CQColorSelector : public QWidget {
 
   CQColorButton *colorButton_ { nullptr };
   CQColorEdit   *colorEdit_   { nullptr };
+
+  QToolButton       *eyedropperButton_ { nullptr };
+  CQColorEyedropper *eyedropper_       { nullptr };
+
+  Colors               paletteColors_;
+  QToolButton         *imageButton_ { nullptr };
+  CQColorSwatches     *swatches_    { nullptr };
+  CQColorImagePreview *preview_     { nullptr };
+
+  HarmonyMode harmonyMode_   { HarmonyMode::NONE };
+  double      harmonySpread_ { 1.0/12.0 };
+
+  CQColorCVD::Type cvdType_ { CQColorCVD::Type::NONE };
+
+  CQColorHistory history_;
+  int            interactionDepth_ { 0 };
+  bool           updating_         { false };
+  bool           applyingHistory_  { false };
+
+  Colors batch_;
+  Colors batchBase_;
+  QColor batchBaseColor_;
+
+  QColor  referenceColor_;
+  QLabel *contrastLabel_ { nullptr };
+
+  CQColorAsyncPreview *asyncPreview_ { nullptr };
+};
+
+//-----
+
+// Input event compression for high frequency (tablet) input.
+//
+// Positions are posted as events arrive and only the latest is applied, at most once
+// per frame interval (immediately if a frame has passed since the last one). The
+// time from the arrival of an applied event to the next paint is recorded as the
+// input to paint latency. The apply function returns whether it scheduled a repaint
+// of the widget, applied positions with no visible change are not sampled.
+class CQColorInputCompressor {
+ public:
+  using Func = std::function<bool (const QPointF &p)>;
+
+ public:
+  CQColorInputCompressor(QWidget *widget, const Func &func);
+
+  //! get/set frame interval (ms)
+  int frameInterval() const { return frameInterval_; }
+  void setFrameInterval(int ms) { frameInterval_ = ms; }
+
+  //! post position (latest replaces pending)
+  void post(const QPointF &p);
+
+  //! apply pending position now
+  void flush();
+
+  //! notify paint done (records latency of applied input)
+  void painted();
+
+  //! get number of posted and applied positions
+  int numPosted () const { return numPosted_; }
+  int numApplied() const { return numApplied_; }
+
+  //! get input to paint latency stats (ms)
+  int    numLatencies() const { return numLatencies_; }
+  double meanLatency () const { return (numLatencies_ ? sumLatency_/numLatencies_ : 0.0); }
+  double maxLatency  () const { return maxLatency_; }
+
+  void resetStats();
+
+ private:
+  QWidget       *widget_;
+  Func           func_;
+  int            frameInterval_ { 16 };
+  QElapsedTimer  clock_;
+  QPointF        pos_;
+  bool           pending_       { false };
+  bool           scheduled_     { false };
+  qint64         postTime_      { 0 };  // arrival time (ns) of pending position
+  qint64         appliedTime_   { -1 }; // arrival time (ns) of applied (unpainted) position
+  qint64         flushTime_     { -1 };
+  int            numPosted_     { 0 };
+  int            numApplied_    { 0 };
+  int            numLatencies_  { 0 };
+  double         sumLatency_    { 0.0 };
+  double         maxLatency_    { 0.0 };
 };
 
 //-----
@@ -147,50 +457,287 @@ class CQColorGradient : public QWidget {
  public:
   CQColorGradient(CQColorSelector *stroke, ColorType type);
 
+  //! render one pixel high strip of colors for channel type (ix set to indicator x).
+  //! Only uses QImage so is safe to call from any thread.
+  static QImage renderStrip(ColorType type, const QColor &c, int width, int &ix);
+
+  //! render full gradient image (checkerboard, strip and indicators) of given size
+  static QImage renderImage(ColorType type, const QColor &c, const QSize &size,
+                            CQColorCVD::Type cvd=CQColorCVD::Type::NONE);
+
+  //! get/set RGB and alpha rows filled with gradient brush instead of sampled strip
+  //! (widget backgrounds are regenerated on next paint after change)
+  static bool isLinearFill();
+  static void setLinearFill(bool b);
+
+  //! get channel type
+  ColorType type() const { return type_; }
+
+  //! update for selector color change (only repaints indicators if background unchanged)
+  void updateColor();
+
+  //! get number of times background has been regenerated
+  int numBackgroundUpdates() const { return numBackgroundUpdates_; }
+
+  void paintEvent(QPaintEvent *e) override;
+
+  void mousePressEvent  (QMouseEvent *e) override;
+  void mouseMoveEvent   (QMouseEvent *e) override;
+  void mouseReleaseEvent(QMouseEvent *e) override;
+
+  void tabletEvent(QTabletEvent *e) override;
+
+  //! get tablet input compressor (latency stats)
+  const CQColorInputCompressor &tabletInput() const { return tabletInput_; }
+
+ private:
+  // state background (checkerboard, strip and contours) is drawn for
+  struct BackgroundKey {
+    QSize    size;
+    double   dpr        { 1.0 };
+    uint64_t components { 0 };
+    int      cvd        { 0 };
+    QRgb     reference  { 0 };
+    bool     hasRef     { false };
+    bool     linear     { true };
+
+    bool operator==(const BackgroundKey &rhs) const {
+      return (size == rhs.size && dpr == rhs.dpr && components == rhs.components &&
+              cvd == rhs.cvd && reference == rhs.reference && hasRef == rhs.hasRef &&
+              linear == rhs.linear);
+    }
+
+    bool operator!=(const BackgroundKey &rhs) const { return ! operator==(rhs); }
+  };
+
+  BackgroundKey backgroundKey() const;
+
+  void updateBackground(const BackgroundKey &key);
+
+  QRect indicatorRect(int x) const;
+
+  void drawContours(QPainter *p, const QImage &strip);
+
+  void setPositionValue(double x);
+
+ private:
+  CQColorSelector       *stroke_               { nullptr };
+  ColorType              type_;
+  std::vector<double>    lum_;                         // per pixel luminance of strip
+  QImage                 background_;                  // cached background (no indicators)
+  BackgroundKey          backgroundKey_;
+  int                    numBackgroundUpdates_ { 0 };
+  int                    ix_                   { -1 }; // painted indicator x
+  bool                   updatePending_        { false };
+  bool                   pressed_              { false }; // left button (or pen) down
+  CQColorInputCompressor tabletInput_;
+};
+
+//-----
+
+// Compact channel rows (label, gradient and value field) painted and edited by a
+// single widget instead of a label, gradient and spin box widget per channel.
+//
+// Value fields are edited inline (digits, Up/Down, mouse wheel) and all hit-testing
+// is done against the cached row rectangles.
+class CQColorChannelPanel : public QWidget {
+ public:
+  typedef CQColorSelector::ColorType ColorType;
+
+  struct Channel {
+    Channel(const QString &label, ColorType type) :
+     label(label), type(type) {
+    }
+
+    QString   label;
+    ColorType type;
+  };
+
+  using Channels = std::vector<Channel>;
+
+ public:
+  CQColorChannelPanel(CQColorSelector *stroke, const Channels &channels);
+
+  const Channels &channels() const { return channels_; }
+
+  QSize sizeHint() const override;
+  QSize minimumSizeHint() const override;
+
+ protected:
   void paintEvent(QPaintEvent *) override;
 
+  void resizeEvent(QResizeEvent *) override;
+
   void mousePressEvent  (QMouseEvent *e) override;
   void mouseMoveEvent   (QMouseEvent *e) override;
   void mouseReleaseEvent(QMouseEvent *e) override;
 
+  void wheelEvent(QWheelEvent *e) override;
+
+  void keyPressEvent(QKeyEvent *e) override;
+
+  void focusOutEvent(QFocusEvent *e) override;
+
  private:
-  CQColorSelector *stroke_ { nullptr };
-  ColorType        type_;
+  enum class Part {
+    NONE,
+    LABEL,
+    GRADIENT,
+    VALUE
+  };
+
+  struct Row {
+    QRect labelRect;
+    QRect gradientRect;
+    QRect valueRect;
+  };
+
+  void calcLayout();
+
+  bool hitTest(const QPoint &p, int &row, Part &part) const;
+
+  int value(int row) const;
+
+  void setValue(int row, int v);
+
+  void setGradientValue(int row, int x);
+
+  void startEdit(int row);
+  void commitEdit();
+  void cancelEdit();
+
+ private:
+  CQColorSelector  *stroke_;
+  Channels          channels_;
+  std::vector<Row>  rows_;
+  int               rowHeight_  { 0 };
+  int               labelWidth_ { 0 };
+  int               valueWidth_ { 0 };
+  int               dragRow_    { -1 };
+  int               editRow_    { -1 };
+  QString           editText_;
+  bool              editFresh_  { false }; // next digit replaces text
 };
 
 //-----
 
 class CQColorSelectorWheel : public QWidget {
+ public:
+  // wheel geometry for square of given size (y up)
+  struct Geometry {
+    double ps { 0.0 };                 // size
+    double xc { 0.0 }, yc { 0.0 };     // center
+    double ri { 0.0 }, ro { 0.0 };     // inner and outer ring radius
+    double xt1 { 0.0 }, yt1 { 0.0 };   // triangle corners
+    double xt2 { 0.0 }, yt2 { 0.0 };
+    double xt3 { 0.0 }, yt3 { 0.0 };
+
+    void init(int size);
+
+    void calcTriangle(double h);
+
+    QRect triangleRect() const;
+
+    double pointToHue(double x, double y) const;
+
+    void angleToPoint(double r, double a, double &x, double &y) const;
+
+    bool toBarycentric(double x, double y, double &b1, double &b2, double &b3) const;
+
+    static double triangleArea2(double x1, double y1, double x2, double y2,
+                                double x3, double y3);
+
+    static double pointLineDistance(double x, double y, double xl1, double yl1,
+                                    double xl2, double yl2);
+  };
+
  public:
   CQColorSelectorWheel(CQColorSelector *stroke);
 
+  //! render hue ring image of given size.
+  //! Render functions only use QImage/QPainter on images so are safe to call from any thread.
+  static QImage renderRing(int size, CQColorCVD::Type cvd=CQColorCVD::Type::NONE);
+
+  //! render saturation/lightness triangle image for hue (pos set to image position,
+  //! optional per pixel luminance, -1 outside)
+  static QImage renderTriangle(const Geometry &geom, double h, CQColorCVD::Type cvd,
+                               QPoint &pos, std::vector<float> *lums=nullptr);
+
+  //! render full wheel image (ring, triangle and color markers) for color
+  static QImage renderImage(const QColor &c, int size,
+                            CQColorCVD::Type cvd=CQColorCVD::Type::NONE);
+
   void paintEvent(QPaintEvent *) override;
 
+  void resizeEvent(QResizeEvent *) override;
+
   void mousePressEvent  (QMouseEvent *e) override;
   void mouseMoveEvent   (QMouseEvent *e) override;
   void mouseReleaseEvent(QMouseEvent *e) override;
 
+  void contextMenuEvent(QContextMenuEvent *e) override;
+
+  void tabletEvent(QTabletEvent *e) override;
+
+  //! get tablet input compressor (latency stats)
+  const CQColorInputCompressor &tabletInput() const { return tabletInput_; }
+
+  //! repaint for selector color or harmony change
+  void updateColor();
+
+  //! clear cached ring and triangle images
+  void clearCache();
+
  private:
-  bool updateCircle  (int x, int y, bool updatePos);
-  bool updateTriangle(int x, int y, bool updatePos);
+  void calcGeometry();
+
+  // cached layers (ring depends on size, triangle on size and hue)
+  void updateRingImage();
+  void updateTriangleImage(double h);
+  void updateContourImage();
+
+  // overlay (hue line, harmony markers and color marker) drawn on cached layers
+  void drawOverlay(QPainter *p);
+
+  static void drawColorMarkers(QPainter *p, const Geometry &geom, const QColor &c,
+                               CQColorCVD::Type cvd);
 
-  void angleToPoint(double r, double a, double &x, double &y);
+  // press, drag and release at (sub-pixel) position
+  void pressAt  (const QPointF &p);
+  void moveAt   (const QPointF &p);
+  void releaseAt(const QPointF &p);
 
-  bool toBarycentric(double x, double y, double &b1, double &b2, double &b3);
+  bool updateCircle  (double x, double y, bool updatePos);
+  bool updateTriangle(double x, double y, bool updatePos);
 
-  double triangleArea2(double x1, double y1, double x2, double y2, double x3, double y3);
+  double pointToHue(double x, double y) const;
 
-  double pointLineDistance(double x, double y, double xl1, double yl1, double xl2, double yl2);
+  void harmonyMarkerPoint(double hue, double &x, double &y);
+  int  harmonyMarkerAt(double x, double y);
+  void updateHarmony(double x, double y);
+
+  double markerRadius() const;
 
  private:
-  CQColorSelector *stroke_;
-  bool             circle_;
-  bool             triangle_;
-  int              pressX_, pressY_;
-  double           ps_;
-  double           xc_, yc_;
-  double           ri_, ro_;
-  double           xt1_, yt1_, xt2_, yt2_, xt3_, yt3_;
+  CQColorSelector       *stroke_;
+  bool                   circle_;
+  bool                   triangle_;
+  double                 pressX_, pressY_;
+  Geometry               geom_;
+  CQColorInputCompressor tabletInput_;
+  int                    harmony_         { -1 };
+  bool                   pressed_         { false }; // left button (or pen) down
+  bool                   updatePending_   { false }; // updateColor not yet painted
+  QImage                 ringImage_;
+  QImage                 triangleImage_;
+  QPoint                 trianglePos_;
+  double                 triangleHue_     { 0.0 };
+  int                    triangleSize_    { 0 };
+  std::vector<float>     triangleLum_;        // per pixel triangle luminance (-1 outside)
+  int                    triangleUpdates_ { 0 };
+  QImage                 contourImage_;
+  QRgb                   contourRef_      { 0 };
+  int                    contourUpdates_  { -1 };
 };
 
 //-----
@@ -207,9 +754,13 @@ class CQColorSpin : public QSpinBox {
  private slots:
   void setColorSlot(int v);
 
+  void burstEndSlot();
+
  private:
   CQColorSelector *stroke_;
   ColorType        type_;
+  QTimer          *burstTimer_ { nullptr };
+  bool             burst_      { false };
 };
 
 //-----
@@ -220,13 +771,105 @@ class CQColorButton : public QToolButton {
  public:
   CQColorButton(CQColorSelector *stroke, const QColor &c);
 
+  const QColor &color() const { return c_; }
   void setColor(const QColor &c);
 
+  //! get/set popup mode (click shows pooled selector popup to edit color)
+  bool isPopup() const { return popup_; }
+  void setPopup(bool b);
+
   void paintEvent(QPaintEvent *) override;
 
+  bool eventFilter(QObject *o, QEvent *e) override;
+
+  //! draw color swatch (checkerboard under color) in rect
+  static void drawColor(QPainter *painter, const QRect &rect, const QColor &c);
+
+ signals:
+  void colorChanged(const QColor &c);
+
+ private slots:
+  void showPopupSlot();
+
+  void popupColorSlot(const QColor &c);
+
+ private:
+  void releasePopup();
+
  private:
   CQColorSelector *stroke_ { nullptr };
   QColor           c_;
+  bool             popup_  { false };
+  CQColorSelector *popupSelector_ { nullptr };
+};
+
+//-----
+
+class CQColorSwatches : public QWidget {
+  Q_OBJECT
+
+ public:
+  using Colors = CQColorSelector::Colors;
+
+ public:
+  CQColorSwatches(CQColorSelector *stroke);
+
+  const Colors &colors() const { return colors_; }
+  void setColors(const Colors &colors);
+
+  void paintEvent(QPaintEvent *) override;
+
+  void mousePressEvent(QMouseEvent *e) override;
+
+  QSize sizeHint() const override;
+
+ signals:
+  void colorPressed(const QColor &c);
+
+ private:
+  int swatchSize() const;
+
+ private:
+  CQColorSelector *stroke_ { nullptr };
+  Colors           colors_;
+};
+
+//-----
+
+class CQColorImagePreview : public QWidget {
+ public:
+  using Colors = CQColorSelector::Colors;
+
+ public:
+  CQColorImagePreview(CQColorSelector *stroke);
+
+  const QImage &image() const { return image_; }
+  void setImage(const QImage &image);
+
+  const Colors &colors() const { return colors_; }
+  void setColors(const Colors &colors);
+
+  bool isDither() const { return dither_; }
+  void setDither(bool b);
+
+  //! get image mapped to colors at preview size
+  const QImage &mappedImage() const { return mapped_; }
+
+  void paintEvent(QPaintEvent *) override;
+
+  void resizeEvent(QResizeEvent *) override;
+
+  QSize sizeHint() const override;
+
+ private:
+  void updateMapped();
+
+ private:
+  CQColorSelector *stroke_ { nullptr };
+  QImage           image_;
+  Colors           colors_;
+  bool             dither_ { false };
+  QImage           mapped_;
 };
 
 //-----
@@ -239,6 +882,13 @@ class CQColorEdit : public QLineEdit {
 
   void setColor(const QColor &c);
 
+  //! parse color string (#rgb, #rgba, #rrggbb, #rrggbbaa, color name or CSS rgb(),
+  //! rgba(), hsl(), hsla() or cmyk() function). Returns false if invalid
+  static bool parseColor(const QString &str, QColor &c);
+
+  //! parse latin1 color string (no allocation for hex and CSS functions)
+  static bool parseColor(const char *str, int len, QColor &c);
+
  signals:
   void colorChanged(const QColor &c);
 
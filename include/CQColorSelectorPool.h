@@ -0,0 +1,58 @@
+#ifndef CQColorSelectorPool_H
+#define CQColorSelectorPool_H
+
+#include <QColor>
+#include <qnamespace.h>
+#include <vector>
+
+class CQColorSelector;
+class QWidget;
+
+// Pool of pre-constructed color selectors.
+//
+// Building a CQColorSelector (tabs, layouts, spin boxes) is expensive so editors
+// and popups acquire an idle instance from the pool and release it when done.
+// Released selectors emit CQColorSelector::released, are hidden, unparented, have their
+// consumer signal connections removed and their per consumer state reset
+// (CQColorSelector::resetState). Idle
+// selectors are deleted when the application quits.
+class CQColorSelectorPool {
+ public:
+  static CQColorSelectorPool *instance();
+
+  //! get/set max number of idle selectors kept (extra released selectors are deleted)
+  int maxIdle() const { return maxIdle_; }
+  void setMaxIdle(int n);
+
+  //! get number of idle selectors
+  int numIdle() const { return int(idle_.size()); }
+
+  //! get number of selectors created by pool
+  int numCreated() const { return numCreated_; }
+
+  //! create idle selectors so at least n are available
+  void prewarm(int n);
+
+  //! get selector (idle or new) reparented to parent (with window flags) with color
+  //! set and empty history
+  CQColorSelector *acquire(QWidget *parent=nullptr, const QColor &c=QColor(255, 255, 255),
+                           Qt::WindowFlags flags=Qt::WindowFlags());
+
+  //! return selector to pool
+  void release(CQColorSelector *selector);
+
+  //! delete all idle selectors
+  void clear();
+
+ private:
+  CQColorSelectorPool();
+
+  CQColorSelector *create();
+
+ private:
+  std::vector<CQColorSelector *> idle_;
+  int                            maxIdle_    { 4 };
+  int                            numCreated_ { 0 };
+};
+
+#endif
@@ -0,0 +1,125 @@
+#ifndef CQColorStopEditor_H
+#define CQColorStopEditor_H
+
+#include <QWidget>
+#include <QImage>
+#include <QGradient>
+#include <vector>
+
+class CQColorSelector;
+
+// Gradient stop editor.
+//
+// Horizontal bar showing the gradient with draggable stops below it. The current
+// stop is edited with a bound CQColorSelector. The bar is drawn from a cached one
+// pixel high strip which is only regenerated when the stops (or size/space) change.
+class CQColorStopEditor : public QWidget {
+  Q_OBJECT
+
+ public:
+  enum class Space {
+    RGB,
+    LINEAR_RGB,
+    HSL
+  };
+
+  struct Stop {
+    Stop() { }
+
+    Stop(double pos, const QColor &color) :
+     pos(pos), color(color) {
+    }
+
+    double pos { 0.0 };
+    QColor color;
+  };
+
+  using Stops = std::vector<Stop>;
+
+ public:
+  CQColorStopEditor(QWidget *parent=nullptr, CQColorSelector *selector=nullptr);
+
+  //! get/set stops (empty stops are ignored)
+  const Stops &stops() const { return stops_; }
+  void setStops(const Stops &stops);
+
+  //! add stop (returns index)
+  int addStop(double pos, const QColor &color);
+
+  //! remove stop (at least two stops are kept)
+  void removeStop(int i);
+
+  //! get/set current stop (edited by selector)
+  int currentStop() const { return current_; }
+  void setCurrentStop(int i);
+
+  //! get/set interpolation color space
+  Space space() const { return space_; }
+  void setSpace(Space space);
+
+  //! get/set selector used to edit current stop
+  CQColorSelector *selector() const { return selector_; }
+  void setSelector(CQColorSelector *selector);
+
+  //! get interpolated color at position (0-1)
+  QColor interpColor(double pos) const;
+
+  //! get Qt gradient stops (non RGB spaces are sampled with extra stops)
+  QGradientStops gradientStops(int samplesPerSegment=16) const;
+
+  //! get number of times strip has been regenerated
+  int numStripUpdates() const { return numStripUpdates_; }
+
+  QSize sizeHint() const override;
+
+ signals:
+  void stopsChanged();
+
+  void currentStopChanged(int i);
+
+ protected:
+  void paintEvent(QPaintEvent *) override;
+
+  void resizeEvent(QResizeEvent *) override;
+
+  void mousePressEvent      (QMouseEvent *e) override;
+  void mouseMoveEvent       (QMouseEvent *e) override;
+  void mouseReleaseEvent    (QMouseEvent *e) override;
+  void mouseDoubleClickEvent(QMouseEvent *e) override;
+
+  void keyPressEvent(QKeyEvent *e) override;
+
+ private slots:
+  void selectorColorSlot(const QColor &c);
+
+ private:
+  QRect barRect() const;
+
+  int    posToPixel(double pos) const;
+  double pixelToPos(int x) const;
+
+  int stopAt(const QPoint &p) const;
+
+  void stopsUpdated();
+
+  void updateStrip();
+
+  void updateSelector();
+
+  std::vector<int> sortedStops() const;
+
+  QColor interpColor(const QColor &c1, const QColor &c2, double f) const;
+
+ private:
+  CQColorSelector *selector_        { nullptr };
+  Stops            stops_;
+  int              current_         { 0 };
+  Space            space_           { Space::RGB };
+  QImage           strip_;
+  bool             stripValid_      { false };
+  int              numStripUpdates_ { 0 };
+  int              dragStop_        { -1 };
+  bool             updatingColor_   { false };
+};
+
+#endif
@@ -0,0 +1,113 @@
+#ifndef CQColorSync_H
+#define CQColorSync_H
+
+#include <QObject>
+#include <QColor>
+#include <QByteArray>
+#include <vector>
+
+class CQColorSelector;
+class QLocalServer;
+class QLocalSocket;
+class QTimer;
+
+// Color sync between processes on the same machine.
+//
+// The first process to start a named endpoint listens on a QLocalServer, later ones
+// connect to it with a QLocalSocket and the server relays each message to all other
+// peers. A color change is sent as an 8 byte message (sender id and argb, big endian).
+// Local changes are coalesced so at most one message is sent per interval during
+// drags, and on receive only the last color of a burst is applied. Remote colors are
+// applied to the attached selectors with their change signals ignored so they are
+// not sent back (no echo loops).
+class CQColorSync : public QObject {
+  Q_OBJECT
+
+ public:
+  CQColorSync(const QString &name="CQColorSync", QObject *parent=nullptr);
+ ~CQColorSync();
+
+  //! get endpoint name
+  const QString &name() const { return name_; }
+
+  //! start endpoint (connect to existing server or become server)
+  bool start();
+
+  //! stop endpoint (disconnects all peers)
+  void stop();
+
+  bool isServer() const { return server_ != nullptr; }
+
+  bool isActive() const { return server_ || socket_; }
+
+  //! get number of connected peers (server only)
+  int numPeers() const { return int(peers_.size()); }
+
+  //! add/remove selector (local changes are sent, remote changes applied). Selectors
+  //! are removed when deleted or released to CQColorSelectorPool
+  void addSelector   (CQColorSelector *selector);
+  void removeSelector(CQColorSelector *selector);
+
+  //! get/set coalesce interval (ms) for sending local changes
+  int coalesceInterval() const { return coalesceInterval_; }
+  void setCoalesceInterval(int ms);
+
+  //! send color to peers (coalesced)
+  void sendColor(const QColor &c);
+
+  //! get number of messages sent/received and remote colors applied
+  int numSent    () const { return numSent_; }
+  int numReceived() const { return numReceived_; }
+  int numApplied () const { return numApplied_; }
+
+ signals:
+  //! emitted when remote color applied
+  void colorReceived(const QColor &c);
+
+ private slots:
+  void newConnectionSlot();
+
+  void readSlot();
+
+  void disconnectedSlot();
+
+  void selectorColorSlot(const QColor &c);
+
+  void selectorReleasedSlot();
+
+  void selectorDestroyedSlot(QObject *obj);
+
+  void flushSlot();
+
+ private:
+  static const int MESSAGE_SIZE = 8;
+
+  void addSocket(QLocalSocket *socket);
+
+  void write(const QByteArray &msg, QLocalSocket *skip=nullptr);
+
+  void applyColor(const QColor &c, CQColorSelector *skip=nullptr);
+
+ private:
+  using Selectors = std::vector<CQColorSelector *>;
+  using Sockets   = std::vector<QLocalSocket *>;
+
+  QString       name_;
+  quint32       id_               { 0 };
+  QLocalServer *server_           { nullptr };
+  QLocalSocket *socket_           { nullptr }; // client connection to server
+  Sockets       peers_;                        // server connections to clients
+  Selectors     selectors_;
+  QTimer       *timer_            { nullptr };
+  int           coalesceInterval_ { 16 };
+  QRgb          pending_          { 0 };
+  bool          hasPending_       { false };
+  QRgb          lastRgb_          { 0 };
+  bool          hasLast_          { false };
+  bool          applying_         { false };
+  int           numSent_          { 0 };
+  int           numReceived_      { 0 };
+  int           numApplied_       { 0 };
+};
+
+#endif
@@ -0,0 +1,103 @@
+#include <CQColorAsyncPreview.h>
+#include <chrono>
+
+CQColorAsyncPreview::
+CQColorAsyncPreview(const Func &func, int debounce, QObject *parent) :
+ QObject(parent), func_(func), debounce_(debounce)
+{
+  setObjectName("asyncPreview");
+
+  thread_ = std::thread([this]() { run(); });
+}
+
+CQColorAsyncPreview::
+~CQColorAsyncPreview()
+{
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    stop_ = true;
+
+    // cancel running function
+    ++generation_;
+  }
+
+  cond_.notify_one();
+
+  thread_.join();
+}
+
+void
+CQColorAsyncPreview::
+request(const QColor &c)
+{
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    pending_    = c;
+    hasPending_ = true;
+
+    ++generation_;
+  }
+
+  ++numRequests_;
+
+  cond_.notify_one();
+}
+
+void
+CQColorAsyncPreview::
+run()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  while (true) {
+    cond_.wait(lock, [this]() { return stop_ || hasPending_; });
+
+    if (stop_)
+      break;
+
+    // wait until no new request within debounce time
+    if (debounce_ > 0) {
+      uint generation;
+
+      do {
+        generation = generation_;
+
+        cond_.wait_for(lock, std::chrono::milliseconds(debounce_));
+      } while (! stop_ && generation != generation_);
+
+      if (stop_)
+        break;
+    }
+
+    QColor c          = pending_;
+    uint   generation = generation_;
+
+    hasPending_ = false;
+
+    lock.unlock();
+
+    //---
+
+    ++numRuns_;
+
+    Request request(c, generation, generation_);
+
+    auto result = func_(request);
+
+    // deliver on GUI thread (dropped if superseded by then)
+    if (! request.isCancelled()) {
+      QMetaObject::invokeMethod(this, [this, c, result, generation]() {
+        if (generation != generation_)
+          return;
+
+        ++numResults_;
+
+        emit resultReady(c, result);
+      }, Qt::QueuedConnection);
+    }
+
+    lock.lock();
+  }
+}
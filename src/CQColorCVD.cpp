@@ -0,0 +1,158 @@
+#include <CQColorCVD.h>
+#include <CQColorSRGB.h>
+#include <algorithm>
+#include <vector>
+#include <cmath>
+
+namespace {
+
+const int LINEAR_BITS = 12;
+const int LINEAR_SIZE = 1<<LINEAR_BITS;
+
+// linear (quantized to LINEAR_BITS) to sRGB (8 bit)
+const uchar *toSRGBTable() {
+  static std::vector<uchar> table = []() {
+    std::vector<uchar> table1(LINEAR_SIZE);
+
+    for (int i = 0; i < LINEAR_SIZE; ++i) {
+      double c = double(i)/(LINEAR_SIZE - 1);
+
+      double s = CQColorSRGB::fromLinear(c);
+
+      table1[i] = uchar(std::min(std::max(int(s*255.0 + 0.5), 0), 255));
+    }
+
+    return table1;
+  }();
+
+  return &table[0];
+}
+
+// Machado, Oliveira and Fernandes (2009), severity 1.0
+const float *cvdMatrix(CQColorCVD::Type type) {
+  static const float protan[9] = {
+     0.152286f,  1.052583f, -0.204868f,
+     0.114503f,  0.786281f,  0.099216f,
+    -0.003882f, -0.048116f,  1.051998f };
+
+  static const float deutan[9] = {
+     0.367322f,  0.860646f, -0.227968f,
+     0.280085f,  0.672501f,  0.047413f,
+    -0.011820f,  0.042940f,  0.968881f };
+
+  static const float tritan[9] = {
+     1.255528f, -0.076749f, -0.178779f,
+    -0.078411f,  0.930809f,  0.147602f,
+     0.004733f,  0.691367f,  0.303900f };
+
+  switch (type) {
+    case CQColorCVD::Type::PROTAN: return protan;
+    case CQColorCVD::Type::DEUTAN: return deutan;
+    case CQColorCVD::Type::TRITAN: return tritan;
+    default:                       return nullptr;
+  }
+}
+
+}
+
+//------
+
+namespace CQColorCVD {
+
+QColor
+simulate(const QColor &c, Type type)
+{
+  if (type == Type::NONE || ! c.isValid())
+    return c;
+
+  QRgb rgb = c.rgba();
+
+  simulateRow(&rgb, 1, type);
+
+  return QColor::fromRgba(rgb);
+}
+
+void
+simulateRow(QRgb *pixels, int n, Type type, bool premultiplied)
+{
+  const float *m = cvdMatrix(type);
+
+  if (! m || n <= 0)
+    return;
+
+  const float *toLinear = CQColorSRGB::toLinearTable();
+  const uchar *toSRGB   = toSRGBTable();
+
+  // process in blocks of channel arrays
+  const int BLOCK = 256;
+
+  float r[BLOCK], g[BLOCK], b[BLOCK];
+  float r1[BLOCK], g1[BLOCK], b1[BLOCK];
+
+  const float scale = float(LINEAR_SIZE - 1);
+
+  for (int i0 = 0; i0 < n; i0 += BLOCK) {
+    int nb = std::min(BLOCK, n - i0);
+
+    QRgb *p = pixels + i0;
+
+    // unpack
+    for (int i = 0; i < nb; ++i) {
+      QRgb rgb = p[i];
+
+      if (premultiplied && qAlpha(rgb) != 255 && qAlpha(rgb) != 0)
+        rgb = qUnpremultiply(rgb);
+
+      r[i] = toLinear[qRed  (rgb)];
+      g[i] = toLinear[qGreen(rgb)];
+      b[i] = toLinear[qBlue (rgb)];
+    }
+
+    // 3x3 matrix (vectorizable)
+    for (int i = 0; i < nb; ++i) {
+      r1[i] = m[0]*r[i] + m[1]*g[i] + m[2]*b[i];
+      g1[i] = m[3]*r[i] + m[4]*g[i] + m[5]*b[i];
+      b1[i] = m[6]*r[i] + m[7]*g[i] + m[8]*b[i];
+    }
+
+    for (int i = 0; i < nb; ++i) {
+      r1[i] = std::min(std::max(r1[i], 0.0f), 1.0f)*scale + 0.5f;
+      g1[i] = std::min(std::max(g1[i], 0.0f), 1.0f)*scale + 0.5f;
+      b1[i] = std::min(std::max(b1[i], 0.0f), 1.0f)*scale + 0.5f;
+    }
+
+    // pack
+    for (int i = 0; i < nb; ++i) {
+      int a = qAlpha(p[i]);
+
+      QRgb rgb = qRgba(toSRGB[int(r1[i])], toSRGB[int(g1[i])], toSRGB[int(b1[i])], a);
+
+      if (premultiplied && a != 255)
+        rgb = qPremultiply(rgb);
+
+      p[i] = rgb;
+    }
+  }
+}
+
+void
+simulateImage(QImage &image, Type type)
+{
+  if (type == Type::NONE || image.isNull())
+    return;
+
+  if (image.format() != QImage::Format_RGB32 &&
+      image.format() != QImage::Format_ARGB32 &&
+      image.format() != QImage::Format_ARGB32_Premultiplied)
+    image = image.convertToFormat(QImage::Format_ARGB32);
+
+  bool premultiplied = (image.format() == QImage::Format_ARGB32_Premultiplied);
+
+  int w = image.width ();
+  int h = image.height();
+
+  for (int y = 0; y < h; ++y)
+    simulateRow(reinterpret_cast<QRgb *>(image.scanLine(y)), w, type, premultiplied);
+}
+
+}
@@ -0,0 +1,108 @@
+#include <CQColorContrast.h>
+#include <CQColorSRGB.h>
+#include <cmath>
+
+namespace {
+
+const double s_thresholds[] = { 3.0, 4.5, 7.0 };
+
+// APCA screen luminance (simple 2.4 exponent with soft black clamp)
+double apcaY(const QColor &c) {
+  double y = 0.2126729*std::pow(c.redF  (), 2.4) +
+             0.7151522*std::pow(c.greenF(), 2.4) +
+             0.0721750*std::pow(c.blueF (), 2.4);
+
+  if (y < 0.022)
+    y += std::pow(0.022 - y, 1.414);
+
+  return y;
+}
+
+}
+
+//------
+
+namespace CQColorContrast {
+
+double
+luminance(QRgb rgb)
+{
+  // WCAG 2.x luminance uses its own linear segment threshold
+  static const double *table = CQColorSRGB::toLinearWCAGTable();
+
+  return 0.2126*table[qRed(rgb)] + 0.7152*table[qGreen(rgb)] + 0.0722*table[qBlue(rgb)];
+}
+
+double
+luminance(const QColor &c)
+{
+  return luminance(c.rgb());
+}
+
+double
+contrastRatio(double l1, double l2)
+{
+  if (l1 < l2)
+    std::swap(l1, l2);
+
+  return (l1 + 0.05)/(l2 + 0.05);
+}
+
+double
+contrastRatio(const QColor &c1, const QColor &c2)
+{
+  return contrastRatio(luminance(c1), luminance(c2));
+}
+
+double
+apca(const QColor &text, const QColor &bg)
+{
+  double yt = apcaY(text);
+  double yb = apcaY(bg);
+
+  if (std::fabs(yb - yt) < 0.0005)
+    return 0.0;
+
+  double s;
+
+  if (yb > yt) {
+    // dark text on light background
+    s = (std::pow(yb, 0.56) - std::pow(yt, 0.57))*1.14;
+
+    s = (s < 0.1 ? 0.0 : s - 0.027);
+  }
+  else {
+    // light text on dark background
+    s = (std::pow(yb, 0.65) - std::pow(yt, 0.62))*1.14;
+
+    s = (s > -0.1 ? 0.0 : s + 0.027);
+  }
+
+  return s*100.0;
+}
+
+int
+numThresholds()
+{
+  return int(sizeof(s_thresholds)/sizeof(s_thresholds[0]));
+}
+
+double
+threshold(int i)
+{
+  return s_thresholds[i];
+}
+
+int
+level(double ratio)
+{
+  int l = 0;
+
+  for (int i = 0; i < numThresholds(); ++i)
+    if (ratio >= s_thresholds[i])
+      ++l;
+
+  return l;
+}
+
+}
@@ -0,0 +1,132 @@
+#include <CQColorDelegate.h>
+#include <CQColorSelectorPool.h>
+#include <QApplication>
+#include <QPainter>
+
+CQColorDelegate::
+CQColorDelegate(QObject *parent) :
+ QStyledItemDelegate(parent)
+{
+}
+
+void
+CQColorDelegate::
+paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+  auto var = index.data(role_);
+
+  if (! var.canConvert<QColor>()) {
+    QStyledItemDelegate::paint(painter, option, index);
+    return;
+  }
+
+  auto c = var.value<QColor>();
+
+  //---
+
+  // item background (selection)
+  QStyleOptionViewItem opt = option;
+
+  initStyleOption(&opt, index);
+
+  opt.text = QString();
+  opt.icon = QIcon();
+
+  const QWidget *widget = option.widget;
+
+  QStyle *style = (widget ? widget->style() : QApplication::style());
+
+  style->drawControl(QStyle::CE_ItemViewItem, &opt, painter, widget);
+
+  if (! c.isValid())
+    return;
+
+  //---
+
+  QRect rect = option.rect.adjusted(2, 2, -2, -2);
+
+  if (rect.width() <= 0 || rect.height() <= 0)
+    return;
+
+  if (style_ == Style::GRADIENT)
+    painter->drawImage(rect.topLeft(),
+      CQColorGradient::renderImage(gradientType_, c, rect.size()));
+  else
+    CQColorButton::drawColor(painter, rect, c);
+
+  painter->setPen(option.palette.color(QPalette::Mid));
+  painter->setBrush(Qt::NoBrush);
+
+  painter->drawRect(rect.adjusted(0, 0, -1, -1));
+}
+
+QWidget *
+CQColorDelegate::
+createEditor(QWidget *parent, const QStyleOptionViewItem &, const QModelIndex &index) const
+{
+  auto c = index.data(role_).value<QColor>();
+
+  auto *selector = CQColorSelectorPool::instance()->acquire(parent, c);
+
+  selector->setAutoFillBackground(true);
+
+  // commit as color changes so the cell updates while editing
+  connect(selector, &CQColorSelector::colorChanged, this, [this, selector]() {
+    auto *th = const_cast<CQColorDelegate *>(this);
+
+    emit th->commitData(selector);
+  });
+
+  return selector;
+}
+
+void
+CQColorDelegate::
+destroyEditor(QWidget *editor, const QModelIndex &) const
+{
+  CQColorSelectorPool::instance()->release(qobject_cast<CQColorSelector *>(editor));
+}
+
+void
+CQColorDelegate::
+setEditorData(QWidget *editor, const QModelIndex &index) const
+{
+  auto *selector = qobject_cast<CQColorSelector *>(editor);
+
+  auto c = index.data(role_).value<QColor>();
+
+  if (selector && c.isValid() && c != selector->color())
+    selector->setColor(c);
+}
+
+void
+CQColorDelegate::
+setModelData(QWidget *editor, QAbstractItemModel *model, const QModelIndex &index) const
+{
+  auto *selector = qobject_cast<CQColorSelector *>(editor);
+
+  if (selector)
+    model->setData(index, selector->color(), role_);
+}
+
+void
+CQColorDelegate::
+updateEditorGeometry(QWidget *editor, const QStyleOptionViewItem &option,
+                     const QModelIndex &) const
+{
+  // selector is larger than a cell so position at cell kept inside parent
+  QSize s = editor->sizeHint();
+
+  QRect rect(option.rect.topLeft(), s);
+
+  auto *parent = editor->parentWidget();
+
+  if (parent) {
+    if (rect.right () > parent->width ()) rect.moveRight (parent->width () - 1);
+    if (rect.bottom() > parent->height()) rect.moveBottom(parent->height() - 1);
+    if (rect.left  () < 0               ) rect.moveLeft  (0);
+    if (rect.top   () < 0               ) rect.moveTop   (0);
+  }
+
+  editor->setGeometry(rect);
+}
@@ -0,0 +1,370 @@
+#include <CQColorEventLog.h>
+#include <QApplication>
+#include <QMouseEvent>
+#include <QTabletEvent>
+#include <QDataStream>
+#include <QFile>
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <thread>
+
+namespace {
+
+const quint32 MAGIC   = 0x43514556; // CQEV
+const quint16 VERSION = 1;
+
+using Target = CQColorEventLog::Target;
+
+// get visible target widget of selector
+QWidget *findTarget(CQColorSelector *selector, Target target,
+                    CQColorSelector::ColorType channel) {
+  for (auto *w : selector->findChildren<QWidget *>()) {
+    if (! w->isVisible())
+      continue;
+
+    if (target == Target::GRADIENT) {
+      auto *gradient = dynamic_cast<CQColorGradient *>(w);
+
+      if (gradient && gradient->type() == channel)
+        return gradient;
+    }
+    else {
+      if (dynamic_cast<CQColorSelectorWheel *>(w))
+        return w;
+    }
+  }
+
+  return nullptr;
+}
+
+quint16 toUnit16(double r) {
+  return quint16(std::min(std::max(r, 0.0), 1.0)*65535 + 0.5);
+}
+
+double fromUnit16(quint16 i) {
+  return i/65535.0;
+}
+
+}
+
+//------
+
+bool
+CQColorEventLog::
+load(const QString &filename)
+{
+  QFile file(filename);
+
+  if (! file.open(QIODevice::ReadOnly))
+    return false;
+
+  QDataStream ds(&file);
+
+  quint32 magic, rgba, count;
+  quint16 version;
+  quint8  mode;
+
+  ds >> magic >> version >> mode >> rgba >> count;
+
+  if (ds.status() != QDataStream::Ok || magic != MAGIC || version != VERSION)
+    return false;
+
+  mode_  = CQColorSelector::ColorMode(mode);
+  color_ = QColor::fromRgba(rgba);
+
+  events_.clear();
+
+  qint64 time = 0;
+
+  for (quint32 i = 0; i < count; ++i) {
+    quint32 dt;
+    quint8  type, target, channel, buttons;
+    quint16 x, y, pressure;
+
+    ds >> dt >> type >> target >> channel >> buttons >> x >> y >> pressure;
+
+    if (ds.status() != QDataStream::Ok)
+      return false;
+
+    time += dt;
+
+    Event event;
+
+    event.time     = time;
+    event.type     = Type(type);
+    event.target   = Target(target);
+    event.channel  = CQColorSelector::ColorType(channel);
+    event.button   = Qt::MouseButton(buttons & 0xF);
+    event.buttons  = Qt::MouseButtons(buttons >> 4);
+    event.pos      = QPointF(fromUnit16(x), fromUnit16(y));
+    event.pressure = fromUnit16(pressure);
+
+    events_.push_back(event);
+  }
+
+  return true;
+}
+
+bool
+CQColorEventLog::
+save(const QString &filename) const
+{
+  QFile file(filename);
+
+  if (! file.open(QIODevice::WriteOnly))
+    return false;
+
+  QDataStream ds(&file);
+
+  ds << MAGIC << VERSION << quint8(mode_) << quint32(color_.rgba()) <<
+        quint32(events_.size());
+
+  qint64 time = 0;
+
+  for (const auto &event : events_) {
+    auto dt = quint32(std::min(std::max(event.time - time, qint64(0)),
+                               qint64(std::numeric_limits<quint32>::max())));
+
+    time = event.time;
+
+    quint8 buttons = quint8((int(event.button) & 0xF) | ((int(event.buttons) & 0xF) << 4));
+
+    ds << dt << quint8(event.type) << quint8(event.target) << quint8(event.channel) <<
+          buttons << toUnit16(event.pos.x()) << toUnit16(event.pos.y()) <<
+          toUnit16(event.pressure);
+  }
+
+  return (ds.status() == QDataStream::Ok);
+}
+
+CQColorEventLog::FrameStats
+CQColorEventLog::
+replay(CQColorSelector *selector, Speed speed) const
+{
+  FrameStats stats;
+
+  selector->setMode (mode_);
+  selector->setColor(color_);
+
+  QApplication::processEvents();
+
+  //---
+
+  QElapsedTimer clock, frameTimer;
+
+  clock.start();
+
+  for (const auto &event : events_) {
+    // wait for recorded time (processing timers, e.g. input compression)
+    if (speed == Speed::ORIGINAL) {
+      while (true) {
+        qint64 dt = event.time - clock.nsecsElapsed()/1000;
+
+        if (dt <= 0)
+          break;
+
+        std::this_thread::sleep_for(std::chrono::microseconds(std::min(dt, qint64(1000))));
+
+        QApplication::processEvents();
+      }
+    }
+
+    auto *w = findTarget(selector, event.target, event.channel);
+
+    if (! w) {
+      ++stats.numSkipped;
+      continue;
+    }
+
+    QPointF pos(event.pos.x()*(w->width() - 1), event.pos.y()*(w->height() - 1));
+
+    frameTimer.start();
+
+    if      (event.type == Type::MOUSE_PRESS || event.type == Type::MOUSE_MOVE ||
+             event.type == Type::MOUSE_RELEASE) {
+      QEvent::Type type = QEvent::MouseMove;
+
+      if      (event.type == Type::MOUSE_PRESS  ) type = QEvent::MouseButtonPress;
+      else if (event.type == Type::MOUSE_RELEASE) type = QEvent::MouseButtonRelease;
+
+      QMouseEvent e(type, pos, event.button, event.buttons, Qt::NoModifier);
+
+      QApplication::sendEvent(w, &e);
+    }
+    else {
+      QEvent::Type type = QEvent::TabletMove;
+
+      if      (event.type == Type::TABLET_PRESS  ) type = QEvent::TabletPress;
+      else if (event.type == Type::TABLET_RELEASE) type = QEvent::TabletRelease;
+
+      QTabletEvent e(type, pos, w->mapToGlobal(pos.toPoint()), QTabletEvent::Stylus,
+                     QTabletEvent::Pen, event.pressure, 0, 0, 0.0, 0.0, 0, Qt::NoModifier,
+                     0, event.button, event.buttons);
+
+      QApplication::sendEvent(w, &e);
+    }
+
+    // process resulting repaint
+    QApplication::processEvents();
+
+    double ms = frameTimer.nsecsElapsed()/1E6;
+
+    stats.times.push_back(ms);
+
+    stats.totalMs += ms;
+    stats.maxMs    = std::max(stats.maxMs, ms);
+
+    ++stats.numEvents;
+  }
+
+  //---
+
+  const auto &limits = histogramLimits();
+
+  stats.histogram.resize(limits.size());
+
+  for (const auto &ms : stats.times) {
+    auto i = std::lower_bound(limits.begin(), limits.end(), ms) - limits.begin();
+
+    ++stats.histogram[std::min(size_t(i), limits.size() - 1)];
+  }
+
+  if (stats.numEvents > 0)
+    stats.meanMs = stats.totalMs/stats.numEvents;
+
+  return stats;
+}
+
+const std::vector<double> &
+CQColorEventLog::
+histogramLimits()
+{
+  // frame budgets: 1, 2, 4 and 8ms, 60, 30 and 15fps, then slower
+  static std::vector<double> limits = {
+    1.0, 2.0, 4.0, 8.0, 16.7, 33.3, 66.7, std::numeric_limits<double>::infinity() };
+
+  return limits;
+}
+
+//------
+
+CQColorEventRecorder::
+CQColorEventRecorder(QObject *parent) :
+ QObject(parent)
+{
+  setObjectName("eventRecorder");
+}
+
+CQColorEventRecorder::
+~CQColorEventRecorder()
+{
+  stop();
+}
+
+void
+CQColorEventRecorder::
+start(CQColorSelector *selector)
+{
+  stop();
+
+  selector_ = selector;
+
+  log_.clear();
+
+  log_.setMode (selector_->mode());
+  log_.setColor(selector_->color());
+
+  timer_.start();
+
+  qApp->installEventFilter(this);
+}
+
+void
+CQColorEventRecorder::
+stop()
+{
+  if (! selector_)
+    return;
+
+  qApp->removeEventFilter(this);
+
+  selector_ = nullptr;
+}
+
+bool
+CQColorEventRecorder::
+eventFilter(QObject *obj, QEvent *e)
+{
+  using Type = CQColorEventLog::Type;
+
+  auto etype = e->type();
+
+  bool isMouse  = (etype == QEvent::MouseButtonPress || etype == QEvent::MouseMove ||
+                   etype == QEvent::MouseButtonRelease);
+  bool isTablet = (etype == QEvent::TabletPress || etype == QEvent::TabletMove ||
+                   etype == QEvent::TabletRelease);
+
+  if (! isMouse && ! isTablet)
+    return false;
+
+  //---
+
+  auto *w = qobject_cast<QWidget *>(obj);
+
+  if (! w || ! selector_->isAncestorOf(w))
+    return false;
+
+  CQColorEventLog::Event event;
+
+  auto *gradient = dynamic_cast<CQColorGradient *>(w);
+
+  if      (gradient) {
+    event.target  = Target::GRADIENT;
+    event.channel = gradient->type();
+  }
+  else if (dynamic_cast<CQColorSelectorWheel *>(w))
+    event.target = Target::WHEEL;
+  else
+    return false;
+
+  //---
+
+  QPointF pos;
+
+  if (isMouse) {
+    auto *me = static_cast<QMouseEvent *>(e);
+
+    // mouse events synthesized from (unaccepted) tablet events are replayed by tablet
+    if (me->source() != Qt::MouseEventNotSynthesized)
+      return false;
+
+    if      (etype == QEvent::MouseButtonPress  ) event.type = Type::MOUSE_PRESS;
+    else if (etype == QEvent::MouseButtonRelease) event.type = Type::MOUSE_RELEASE;
+    else                                          event.type = Type::MOUSE_MOVE;
+
+    pos           = me->localPos();
+    event.button  = me->button();
+    event.buttons = me->buttons();
+  }
+  else {
+    auto *te = static_cast<QTabletEvent *>(e);
+
+    if      (etype == QEvent::TabletPress  ) event.type = Type::TABLET_PRESS;
+    else if (etype == QEvent::TabletRelease) event.type = Type::TABLET_RELEASE;
+    else                                     event.type = Type::TABLET_MOVE;
+
+    pos            = te->posF();
+    event.button   = te->button();
+    event.buttons  = te->buttons();
+    event.pressure = te->pressure();
+  }
+
+  event.time = timer_.nsecsElapsed()/1000;
+  event.pos  = QPointF(pos.x()/std::max(w->width () - 1, 1),
+                       pos.y()/std::max(w->height() - 1, 1));
+
+  log_.addEvent(event);
+
+  return false;
+}
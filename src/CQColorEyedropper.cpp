@@ -0,0 +1,344 @@
+#include <CQColorEyedropper.h>
+#include <QGuiApplication>
+#include <QScreen>
+#include <QPixmap>
+#include <QPainter>
+#include <QMouseEvent>
+#include <QKeyEvent>
+#include <QCursor>
+#include <QTimer>
+#include <cmath>
+
+namespace {
+
+QImage &syntheticScreen() {
+  static QImage image;
+
+  return image;
+}
+
+}
+
+//------
+
+CQColorEyedropper::
+CQColorEyedropper(QWidget *parent) :
+ QWidget(parent, Qt::Tool | Qt::FramelessWindowHint | Qt::WindowStaysOnTopHint)
+{
+  setObjectName("eyedropper");
+
+  setAttribute(Qt::WA_OpaquePaintEvent);
+
+  setMouseTracking(true);
+
+  timer_ = new QTimer(this);
+
+  connect(timer_, SIGNAL(timeout()), this, SLOT(captureSlot()));
+
+  setFixedSize(sizeHint());
+}
+
+const QImage &
+CQColorEyedropper::
+screenImage()
+{
+  return syntheticScreen();
+}
+
+void
+CQColorEyedropper::
+setScreenImage(const QImage &image)
+{
+  syntheticScreen() = image.convertToFormat(QImage::Format_RGB32);
+}
+
+void
+CQColorEyedropper::
+setRadius(int r)
+{
+  radius_ = std::max(r, 1);
+
+  setFixedSize(sizeHint());
+
+  dirty_ = true;
+}
+
+void
+CQColorEyedropper::
+setZoom(int z)
+{
+  zoom_ = std::max(z, 1);
+
+  setFixedSize(sizeHint());
+
+  update();
+}
+
+void
+CQColorEyedropper::
+start()
+{
+  if (active_)
+    return;
+
+  active_      = true;
+  numCaptures_ = 0;
+
+  pos_   = QCursor::pos();
+  dirty_ = true;
+
+  captureRegion(pos_);
+
+  placeLoupe();
+
+  show();
+
+  grabMouse(Qt::CrossCursor);
+  grabKeyboard();
+
+  updateTimer();
+
+  timer_->start();
+}
+
+void
+CQColorEyedropper::
+stop()
+{
+  if (! active_)
+    return;
+
+  active_ = false;
+
+  timer_->stop();
+
+  releaseKeyboard();
+  releaseMouse();
+
+  hide();
+}
+
+void
+CQColorEyedropper::
+setCursorPos(const QPoint &pos)
+{
+  if (pos == pos_)
+    return;
+
+  pos_   = pos;
+  dirty_ = true;
+
+  // no capture when not active (no frame timer) so capture now
+  if (! active_)
+    captureSlot();
+}
+
+QColor
+CQColorEyedropper::
+pickAt(const QPoint &pos)
+{
+  pos_ = pos;
+
+  captureRegion(pos_);
+
+  return color_;
+}
+
+void
+CQColorEyedropper::
+updateTimer()
+{
+  // throttle captures to display rate
+  auto *screen = QGuiApplication::screenAt(pos_);
+
+  if (! screen)
+    screen = QGuiApplication::primaryScreen();
+
+  double rate = (screen ? screen->refreshRate() : 60.0);
+
+  if (rate <= 0.0)
+    rate = 60.0;
+
+  timer_->setInterval(std::max(int(1000.0/rate), 1));
+}
+
+void
+CQColorEyedropper::
+captureSlot()
+{
+  if (! dirty_ && pos_ == capturePos_)
+    return;
+
+  captureRegion(pos_);
+
+  if (active_)
+    placeLoupe();
+
+  emit colorHovered(color_);
+}
+
+void
+CQColorEyedropper::
+captureRegion(const QPoint &pos)
+{
+  QRect rect(pos.x() - radius_, pos.y() - radius_, 2*radius_ + 1, 2*radius_ + 1);
+
+  region_ = grabRegion(rect);
+
+  capturePos_ = pos;
+  dirty_      = false;
+
+  ++numCaptures_;
+
+  color_ = QColor(region_.pixel(radius_, radius_));
+
+  update();
+}
+
+QImage
+CQColorEyedropper::
+grabRegion(const QRect &rect) const
+{
+  const auto &image = syntheticScreen();
+
+  // synthetic screen (areas outside image are black)
+  if (! image.isNull())
+    return image.copy(rect);
+
+  //---
+
+  auto *screen = QGuiApplication::screenAt(rect.center());
+
+  if (! screen)
+    screen = QGuiApplication::primaryScreen();
+
+  if (! screen) {
+    QImage region(rect.size(), QImage::Format_RGB32);
+
+    region.fill(Qt::black);
+
+    return region;
+  }
+
+  QPoint p = rect.topLeft() - screen->geometry().topLeft();
+
+  auto region = screen->grabWindow(0, p.x(), p.y(), rect.width(), rect.height()).
+                  toImage().convertToFormat(QImage::Format_RGB32);
+
+  // grab is in device pixels for high dpi screens
+  if (region.size() != rect.size())
+    region = region.scaled(rect.size());
+
+  return region;
+}
+
+void
+CQColorEyedropper::
+placeLoupe()
+{
+  // place loupe below right of cursor, flip if off screen
+  int d = 16;
+
+  QPoint p = pos_ + QPoint(d, d);
+
+  auto *screen = QGuiApplication::screenAt(pos_);
+
+  if (screen) {
+    QRect srect = screen->availableGeometry();
+
+    if (p.x() + width () > srect.right ()) p.setX(pos_.x() - d - width ());
+    if (p.y() + height() > srect.bottom()) p.setY(pos_.y() - d - height());
+  }
+
+  move(p);
+}
+
+void
+CQColorEyedropper::
+mousePressEvent(QMouseEvent *e)
+{
+  if (e->button() != Qt::LeftButton) {
+    stop();
+
+    emit canceled();
+
+    return;
+  }
+
+  // pick exact press position (don't wait for frame)
+  pos_ = e->globalPos();
+
+  captureRegion(pos_);
+
+  stop();
+
+  emit colorPicked(color_);
+}
+
+void
+CQColorEyedropper::
+mouseMoveEvent(QMouseEvent *e)
+{
+  // only record position, capture is done on next frame
+  setCursorPos(e->globalPos());
+}
+
+void
+CQColorEyedropper::
+keyPressEvent(QKeyEvent *e)
+{
+  if      (e->key() == Qt::Key_Escape) {
+    stop();
+
+    emit canceled();
+  }
+  else if (e->key() == Qt::Key_Return || e->key() == Qt::Key_Enter) {
+    captureRegion(pos_);
+
+    stop();
+
+    emit colorPicked(color_);
+  }
+  else if (e->key() == Qt::Key_Left ) setCursorPos(pos_ + QPoint(-1,  0));
+  else if (e->key() == Qt::Key_Right) setCursorPos(pos_ + QPoint( 1,  0));
+  else if (e->key() == Qt::Key_Up   ) setCursorPos(pos_ + QPoint( 0, -1));
+  else if (e->key() == Qt::Key_Down ) setCursorPos(pos_ + QPoint( 0,  1));
+}
+
+void
+CQColorEyedropper::
+paintEvent(QPaintEvent *)
+{
+  QPainter p(this);
+
+  // zoomed region (no smoothing so pixels stay square)
+  if (! region_.isNull())
+    p.drawImage(rect(), region_);
+  else
+    p.fillRect(rect(), Qt::black);
+
+  //---
+
+  // center pixel
+  QRect crect(radius_*zoom_, radius_*zoom_, zoom_, zoom_);
+
+  p.setPen(QColor(0, 0, 0));
+  p.drawRect(crect.adjusted(-1, -1, 0, 0));
+
+  p.setPen(QColor(255, 255, 255));
+  p.drawRect(crect.adjusted(-2, -2, 1, 1));
+
+  //---
+
+  p.setPen(QColor(0, 0, 0));
+  p.drawRect(rect().adjusted(0, 0, -1, -1));
+}
+
+QSize
+CQColorEyedropper::
+sizeHint() const
+{
+  int s = (2*radius_ + 1)*zoom_;
+
+  return QSize(s, s);
+}
@@ -0,0 +1,92 @@
+#include <CQColorHSL.h>
+#include <algorithm>
+#include <atomic>
+#include <vector>
+#include <cmath>
+
+namespace {
+
+const int SEXTANT_SIZE = 1024;
+const int HUE_SIZE     = 6*SEXTANT_SIZE;
+
+std::atomic<bool> s_enabled { true };
+
+// fully saturated (s=1, l=0.5) rgb of hue, stored as (channel - 0.5)
+struct HueTable {
+  HueTable() : r(HUE_SIZE), g(HUE_SIZE), b(HUE_SIZE) { }
+
+  std::vector<float> r, g, b;
+};
+
+const HueTable &hueTable() {
+  static HueTable table = []() {
+    HueTable table1;
+
+    auto clamp01 = [](double v) { return std::min(std::max(v, 0.0), 1.0); };
+
+    for (int i = 0; i < HUE_SIZE; ++i) {
+      double h6 = 6.0*i/HUE_SIZE;
+
+      table1.r[i] = float(clamp01(std::fabs(h6 - 3.0) - 1.0) - 0.5);
+      table1.g[i] = float(clamp01(2.0 - std::fabs(h6 - 2.0)) - 0.5);
+      table1.b[i] = float(clamp01(2.0 - std::fabs(h6 - 4.0)) - 0.5);
+    }
+
+    return table1;
+  }();
+
+  return table;
+}
+
+inline int hueIndex(double h) {
+  h -= std::floor(h);
+
+  int i = int(h*HUE_SIZE + 0.5);
+
+  return (i >= HUE_SIZE ? i - HUE_SIZE : i);
+}
+
+inline int toByte(float v) {
+  return int(std::min(std::max(v, 0.0f), 1.0f)*255.0f + 0.5f);
+}
+
+}
+
+//------
+
+namespace CQColorHSL {
+
+bool
+isEnabled()
+{
+  return s_enabled;
+}
+
+void
+setEnabled(bool b)
+{
+  s_enabled = b;
+}
+
+QRgb
+toRgb(double h, double s, double l, int alpha)
+{
+  if (! s_enabled)
+    return QColor::fromHslF(h, s, l, alpha/255.0).rgba();
+
+  const auto &table = hueTable();
+
+  // achromatic
+  if (h < 0.0)
+    s = 0.0;
+
+  int i = hueIndex(h);
+
+  float c  = float((1.0 - std::fabs(2.0*l - 1.0))*s);
+  float lf = float(l);
+
+  return qRgba(toByte(lf + c*table.r[i]), toByte(lf + c*table.g[i]),
+               toByte(lf + c*table.b[i]), alpha);
+}
+
+}
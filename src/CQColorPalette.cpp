@@ -0,0 +1,588 @@
+#include <CQColorPalette.h>
+#include <CQColorSRGB.h>
+#include <algorithm>
+#include <thread>
+#include <cstdint>
+#include <cmath>
+
+namespace {
+
+const int HIST_BITS = 5;
+const int HIST_SIZE = 1<<(3*HIST_BITS);
+const int HIST_MAX  = (1<<HIST_BITS) - 1;
+
+inline int histIndex(QRgb rgb) {
+  return ((qRed  (rgb) >> (8 - HIST_BITS)) << (2*HIST_BITS)) |
+         ((qGreen(rgb) >> (8 - HIST_BITS)) <<    HIST_BITS ) |
+          (qBlue (rgb) >> (8 - HIST_BITS));
+}
+
+// histogram bin (sums used for box average color)
+struct HistBin {
+  uint32_t count { 0 };
+  uint64_t r     { 0 };
+  uint64_t g     { 0 };
+  uint64_t b     { 0 };
+};
+
+using Histogram = std::vector<HistBin>;
+
+// non-empty histogram cell
+struct Cell {
+  int      c[3];
+  uint64_t count;
+  uint64_t r, g, b;
+};
+
+using Cells = std::vector<Cell>;
+
+// median cut box (range of cells)
+struct Box {
+  int      start { 0 };
+  int      end   { 0 };
+  int      min[3] { 0, 0, 0 };
+  int      max[3] { 0, 0, 0 };
+  uint64_t count { 0 };
+
+  int longestAxis() const {
+    int axis = 0;
+
+    for (int i = 1; i < 3; ++i)
+      if (max[i] - min[i] > max[axis] - min[axis])
+        axis = i;
+
+    return axis;
+  }
+
+  int range() const {
+    int axis = longestAxis();
+
+    return max[axis] - min[axis];
+  }
+};
+
+void updateBox(const Cells &cells, Box &box) {
+  box.count = 0;
+
+  for (int i = 0; i < 3; ++i) {
+    box.min[i] = HIST_MAX;
+    box.max[i] = 0;
+  }
+
+  for (int j = box.start; j < box.end; ++j) {
+    const auto &cell = cells[j];
+
+    for (int i = 0; i < 3; ++i) {
+      box.min[i] = std::min(box.min[i], cell.c[i]);
+      box.max[i] = std::max(box.max[i], cell.c[i]);
+    }
+
+    box.count += cell.count;
+  }
+}
+
+void fillHistogram(const QImage &image, int y1, int y2, int step, Histogram &hist) {
+  bool fast = (image.format() == QImage::Format_RGB32 ||
+               image.format() == QImage::Format_ARGB32);
+
+  int w = image.width();
+
+  for (int y = y1; y < y2; y += step) {
+    if (fast) {
+      auto *line = reinterpret_cast<const QRgb *>(image.constScanLine(y));
+
+      for (int x = 0; x < w; x += step) {
+        QRgb rgb = line[x];
+
+        if (qAlpha(rgb) < 128)
+          continue;
+
+        auto &bin = hist[histIndex(rgb)];
+
+        ++bin.count;
+
+        bin.r += qRed(rgb); bin.g += qGreen(rgb); bin.b += qBlue(rgb);
+      }
+    }
+    else {
+      for (int x = 0; x < w; x += step) {
+        QRgb rgb = image.pixel(x, y);
+
+        if (qAlpha(rgb) < 128)
+          continue;
+
+        auto &bin = hist[histIndex(rgb)];
+
+        ++bin.count;
+
+        bin.r += qRed(rgb); bin.g += qGreen(rgb); bin.b += qBlue(rgb);
+      }
+    }
+  }
+}
+
+//---
+
+// CIE Lab (D65) from 8 bit sRGB
+void rgbToLab(QRgb rgb, float lab[3]) {
+  static const float *table = CQColorSRGB::toLinearTable();
+
+  float r = table[qRed(rgb)], g = table[qGreen(rgb)], b = table[qBlue(rgb)];
+
+  float x = (0.4124564f*r + 0.3575761f*g + 0.1804375f*b)/0.95047f;
+  float y = (0.2126729f*r + 0.7151522f*g + 0.0721750f*b);
+  float z = (0.0193339f*r + 0.1191920f*g + 0.9503041f*b)/1.08883f;
+
+  auto f = [](float t) {
+    return (t > 0.008856f ? std::cbrt(t) : 7.787f*t + 16.0f/116.0f);
+  };
+
+  float fx = f(x), fy = f(y), fz = f(z);
+
+  lab[0] = 116.0f*fy - 16.0f;
+  lab[1] = 500.0f*(fx - fy);
+  lab[2] = 200.0f*(fy - fz);
+}
+
+inline int clampByte(float v) {
+  return (v < 0.0f ? 0 : (v > 255.0f ? 255 : int(v + 0.5f)));
+}
+
+}
+
+//------
+
+namespace CQColorPalette {
+
+NearestColor::Cache::
+Cache() :
+ keys_(SIZE, 0), inds_(SIZE, -1)
+{
+}
+
+//---
+
+NearestColor::
+NearestColor(const Colors &palette, Distance distance) :
+ distance_(distance)
+{
+  std::vector<Point> points;
+
+  for (const auto &c : palette) {
+    Point point;
+
+    toPoint(c.rgb(), point.p);
+
+    point.ind = int(rgbs_.size());
+
+    rgbs_ .push_back(c.rgb());
+    points.push_back(point);
+  }
+
+  nodes_.reserve(points.size());
+
+  root_ = build(points, 0, int(points.size()), 0);
+}
+
+void
+NearestColor::
+toPoint(QRgb rgb, float p[3]) const
+{
+  if (distance_ == Distance::PERCEPTUAL)
+    rgbToLab(rgb, p);
+  else {
+    p[0] = float(qRed(rgb)); p[1] = float(qGreen(rgb)); p[2] = float(qBlue(rgb));
+  }
+}
+
+int
+NearestColor::
+build(std::vector<Point> &points, int start, int end, int depth)
+{
+  if (start >= end)
+    return -1;
+
+  int axis = depth % 3;
+  int mid  = (start + end)/2;
+
+  std::nth_element(points.begin() + start, points.begin() + mid, points.begin() + end,
+                   [&](const Point &lhs, const Point &rhs) { return lhs.p[axis] < rhs.p[axis]; });
+
+  int ind = int(nodes_.size());
+
+  Node node;
+
+  node.pt   = points[mid];
+  node.axis = axis;
+
+  nodes_.push_back(node);
+
+  int left  = build(points, start  , mid, depth + 1);
+  int right = build(points, mid + 1, end, depth + 1);
+
+  nodes_[ind].left  = left;
+  nodes_[ind].right = right;
+
+  return ind;
+}
+
+void
+NearestColor::
+search(int node, const float q[3], int &best, float &bestD) const
+{
+  if (node < 0)
+    return;
+
+  const auto &n = nodes_[node];
+
+  float dx = q[0] - n.pt.p[0];
+  float dy = q[1] - n.pt.p[1];
+  float dz = q[2] - n.pt.p[2];
+
+  float d = dx*dx + dy*dy + dz*dz;
+
+  if (d < bestD) {
+    bestD = d;
+    best  = n.pt.ind;
+  }
+
+  float da = q[n.axis] - n.pt.p[n.axis];
+
+  int near = (da < 0.0f ? n.left  : n.right);
+  int far  = (da < 0.0f ? n.right : n.left );
+
+  search(near, q, best, bestD);
+
+  // other side can only be closer if splitting plane is within best distance
+  if (da*da < bestD)
+    search(far, q, best, bestD);
+}
+
+int
+NearestColor::
+nearest(QRgb rgb) const
+{
+  if (root_ < 0)
+    return -1;
+
+  float q[3];
+
+  toPoint(rgb, q);
+
+  int   best  = -1;
+  float bestD = 1E30f;
+
+  search(root_, q, best, bestD);
+
+  return best;
+}
+
+int
+NearestColor::
+nearest(QRgb rgb, Cache &cache) const
+{
+  // key is rgb with valid bit set
+  uint32_t key = (rgb & 0xffffff) | 0x1000000;
+
+  uint32_t h = ((rgb & 0xffffff)*2654435761u) >> 20;
+
+  if (cache.keys_[h] == key)
+    return cache.inds_[h];
+
+  int ind = nearest(rgb);
+
+  cache.keys_[h] = key;
+  cache.inds_[h] = ind;
+
+  return ind;
+}
+
+//---
+
+QImage
+mapImage(const QImage &image, const Colors &palette, const MapOptions &options)
+{
+  if (image.isNull() || palette.empty())
+    return image;
+
+  QImage src = image;
+
+  if (src.format() != QImage::Format_RGB32 && src.format() != QImage::Format_ARGB32)
+    src = src.convertToFormat(QImage::Format_ARGB32);
+
+  int w = src.width ();
+  int h = src.height();
+
+  QImage dst(w, h, QImage::Format_ARGB32);
+
+  NearestColor nearest(palette, options.distance);
+
+  // destination lines from bits (scanLine() detaches so isn't safe from threads)
+  uchar *dbits = dst.bits();
+  int    dbpl  = dst.bytesPerLine();
+
+  auto dstLine = [&](int y) { return reinterpret_cast<QRgb *>(dbits + y*dbpl); };
+
+  //---
+
+  if (options.dither) {
+    // Floyd-Steinberg (error rows for current and next line)
+    NearestColor::Cache cache;
+
+    std::vector<float> err1(3*(w + 2), 0.0f), err2(3*(w + 2), 0.0f);
+
+    for (int y = 0; y < h; ++y) {
+      auto *sline = reinterpret_cast<const QRgb *>(src.constScanLine(y));
+      auto *dline = dstLine(y);
+
+      std::fill(err2.begin(), err2.end(), 0.0f);
+
+      for (int x = 0; x < w; ++x) {
+        QRgb rgb = sline[x];
+
+        float *e = &err1[3*(x + 1)];
+
+        int r = clampByte(qRed  (rgb) + e[0]);
+        int g = clampByte(qGreen(rgb) + e[1]);
+        int b = clampByte(qBlue (rgb) + e[2]);
+
+        QRgb prgb = nearest.rgb(nearest.nearest(qRgb(r, g, b), cache));
+
+        dline[x] = qRgba(qRed(prgb), qGreen(prgb), qBlue(prgb), qAlpha(rgb));
+
+        float er = float(r - qRed  (prgb));
+        float eg = float(g - qGreen(prgb));
+        float eb = float(b - qBlue (prgb));
+
+        auto spread = [&](float *e1, float f) {
+          e1[0] += er*f; e1[1] += eg*f; e1[2] += eb*f;
+        };
+
+        spread(&err1[3*(x + 2)], 7.0f/16.0f);
+        spread(&err2[3*(x    )], 3.0f/16.0f);
+        spread(&err2[3*(x + 1)], 5.0f/16.0f);
+        spread(&err2[3*(x + 2)], 1.0f/16.0f);
+      }
+
+      std::swap(err1, err2);
+    }
+
+    return dst;
+  }
+
+  //---
+
+  // parallel bands of scanlines, each with own cache
+  int nt = std::min(numThreads(options.numThreads), std::max(h/16, 1));
+
+  auto mapBand = [&](int i) {
+    NearestColor::Cache cache;
+
+    int y1 = (h* i     )/nt;
+    int y2 = (h*(i + 1))/nt;
+
+    for (int y = y1; y < y2; ++y) {
+      auto *sline = reinterpret_cast<const QRgb *>(src.constScanLine(y));
+      auto *dline = dstLine(y);
+
+      for (int x = 0; x < w; ++x) {
+        QRgb rgb  = sline[x];
+        QRgb prgb = nearest.rgb(nearest.nearest(rgb, cache));
+
+        dline[x] = qRgba(qRed(prgb), qGreen(prgb), qBlue(prgb), qAlpha(rgb));
+      }
+    }
+  };
+
+  if (nt > 1) {
+    std::vector<std::thread> threads;
+
+    for (int i = 1; i < nt; ++i)
+      threads.emplace_back(mapBand, i);
+
+    mapBand(0);
+
+    for (auto &thread : threads)
+      thread.join();
+  }
+  else
+    mapBand(0);
+
+  return dst;
+}
+
+int
+numThreads(int n)
+{
+  if (n > 0)
+    return n;
+
+  return std::max(int(std::thread::hardware_concurrency()), 1);
+}
+
+Colors
+dominantColors(const QImage &image, int n, int nt, int maxSamples)
+{
+  Colors colors;
+
+  if (image.isNull() || n <= 0)
+    return colors;
+
+  //---
+
+  // sample step so at most maxSamples pixels are read
+  int w = image.width ();
+  int h = image.height();
+
+  double area = double(w)*double(h);
+
+  int step = std::max(int(std::ceil(std::sqrt(area/std::max(maxSamples, 1)))), 1);
+
+  //---
+
+  // build per thread histograms over bands of sampled rows
+  int numRows = (h + step - 1)/step;
+
+  nt = std::min(numThreads(nt), std::max(numRows/16, 1));
+
+  std::vector<Histogram> hists(nt);
+
+  auto fillBand = [&](int i) {
+    hists[i].resize(HIST_SIZE);
+
+    int r1 = (numRows* i     )/nt;
+    int r2 = (numRows*(i + 1))/nt;
+
+    fillHistogram(image, r1*step, std::min(r2*step, h), step, hists[i]);
+  };
+
+  if (nt > 1) {
+    std::vector<std::thread> threads;
+
+    for (int i = 1; i < nt; ++i)
+      threads.emplace_back(fillBand, i);
+
+    fillBand(0);
+
+    for (auto &thread : threads)
+      thread.join();
+  }
+  else
+    fillBand(0);
+
+  //---
+
+  // merge into list of non-empty cells
+  Cells cells;
+
+  for (int i = 0; i < HIST_SIZE; ++i) {
+    Cell cell;
+
+    cell.count = 0; cell.r = 0; cell.g = 0; cell.b = 0;
+
+    for (const auto &hist : hists) {
+      const auto &bin = hist[i];
+
+      cell.count += bin.count;
+
+      cell.r += bin.r; cell.g += bin.g; cell.b += bin.b;
+    }
+
+    if (! cell.count)
+      continue;
+
+    cell.c[0] = (i >> (2*HIST_BITS)) & HIST_MAX;
+    cell.c[1] = (i >>    HIST_BITS ) & HIST_MAX;
+    cell.c[2] =  i                   & HIST_MAX;
+
+    cells.push_back(cell);
+  }
+
+  if (cells.empty())
+    return colors;
+
+  //---
+
+  // median cut: split box with most pixels (and non-zero range) along
+  // its longest axis at the weighted median
+  std::vector<Box> boxes;
+
+  Box box0;
+
+  box0.start = 0;
+  box0.end   = int(cells.size());
+
+  updateBox(cells, box0);
+
+  boxes.push_back(box0);
+
+  while (int(boxes.size()) < n) {
+    int ib = -1;
+
+    for (int i = 0; i < int(boxes.size()); ++i) {
+      if (boxes[i].range() == 0)
+        continue;
+
+      if (ib < 0 || boxes[i].count > boxes[ib].count)
+        ib = i;
+    }
+
+    if (ib < 0)
+      break;
+
+    Box &box1 = boxes[ib];
+
+    int axis = box1.longestAxis();
+
+    std::sort(cells.begin() + box1.start, cells.begin() + box1.end,
+              [&](const Cell &lhs, const Cell &rhs) { return lhs.c[axis] < rhs.c[axis]; });
+
+    uint64_t half = box1.count/2;
+    uint64_t sum  = 0;
+
+    int mid = box1.start;
+
+    while (mid < box1.end - 1) {
+      sum += cells[mid].count;
+
+      ++mid;
+
+      if (sum >= half)
+        break;
+    }
+
+    Box box2;
+
+    box2.start = mid;
+    box2.end   = box1.end;
+
+    box1.end = mid;
+
+    updateBox(cells, box1);
+    updateBox(cells, box2);
+
+    boxes.push_back(box2);
+  }
+
+  //---
+
+  // average color of each box (most common first)
+  std::sort(boxes.begin(), boxes.end(),
+            [](const Box &lhs, const Box &rhs) { return lhs.count > rhs.count; });
+
+  for (const auto &box : boxes) {
+    uint64_t r = 0, g = 0, b = 0;
+
+    for (int j = box.start; j < box.end; ++j) {
+      r += cells[j].r; g += cells[j].g; b += cells[j].b;
+    }
+
+    uint64_t count = std::max(box.count, uint64_t(1));
+
+    colors.push_back(QColor(int(r/count), int(g/count), int(b/count)));
+  }
+
+  return colors;
+}
+
+}
@@ -0,0 +1,156 @@
+#include <CQColorRenderCache.h>
+#include <algorithm>
+
+CQColorRenderCache *
+CQColorRenderCache::
+instance()
+{
+  static CQColorRenderCache cache;
+
+  return &cache;
+}
+
+CQColorRenderCache::
+CQColorRenderCache()
+{
+}
+
+int64_t
+CQColorRenderCache::
+budget() const
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  return budget_;
+}
+
+void
+CQColorRenderCache::
+setBudget(int64_t bytes)
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  budget_ = std::max(bytes, int64_t(0));
+
+  evict();
+}
+
+QImage
+CQColorRenderCache::
+image(const Key &key, const RenderFunc &func)
+{
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    auto p = index_.find(key);
+
+    if (p != index_.end()) {
+      // move to front (most recently used)
+      entries_.splice(entries_.begin(), entries_, p->second);
+
+      ++stats_.hits;
+
+      return p->second->image;
+    }
+
+    ++stats_.misses;
+  }
+
+  //---
+
+  // render outside lock (other threads may render same key, first insert wins)
+  auto image = func();
+
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  auto p = index_.find(key);
+
+  if (p != index_.end())
+    return p->second->image;
+
+  entries_.push_front(Entry());
+
+  entries_.front().key   = key;
+  entries_.front().image = image;
+
+  index_[key] = entries_.begin();
+
+  stats_.bytes += image.sizeInBytes();
+
+  ++stats_.count;
+
+  evict();
+
+  return image;
+}
+
+void
+CQColorRenderCache::
+clear()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  entries_.clear();
+  index_  .clear();
+
+  stats_.bytes = 0;
+  stats_.count = 0;
+}
+
+CQColorRenderCache::Stats
+CQColorRenderCache::
+stats() const
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  return stats_;
+}
+
+void
+CQColorRenderCache::
+resetStats()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  stats_.hits      = 0;
+  stats_.misses    = 0;
+  stats_.evictions = 0;
+}
+
+void
+CQColorRenderCache::
+evict()
+{
+  // remove least recently used (keep most recent even if over budget)
+  while (stats_.bytes > budget_ && entries_.size() > 1) {
+    const auto &entry = entries_.back();
+
+    stats_.bytes -= entry.image.sizeInBytes();
+
+    --stats_.count;
+
+    ++stats_.evictions;
+
+    index_.erase(entry.key);
+
+    entries_.pop_back();
+  }
+}
+
+size_t
+CQColorRenderCache::KeyHash::
+operator()(const Key &key) const
+{
+  auto combine = [](size_t h, uint64_t v) {
+    return h ^ (std::hash<uint64_t>()(v) + 0x9e3779b97f4a7c15ULL + (h<<6) + (h>>2));
+  };
+
+  size_t h = std::hash<int>()(int(key.kind));
+
+  h = combine(h, uint64_t(key.size.width()));
+  h = combine(h, uint64_t(key.size.height()));
+  h = combine(h, uint64_t(key.dpr*1000.0));
+  h = combine(h, key.components);
+
+  return h;
+}
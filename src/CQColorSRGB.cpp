@@ -0,0 +1,55 @@
+#include <CQColorSRGB.h>
+#include <vector>
+#include <cmath>
+
+namespace CQColorSRGB {
+
+double
+toLinear(double c)
+{
+  return (c <= 0.04045 ? c/12.92 : std::pow((c + 0.055)/1.055, 2.4));
+}
+
+double
+fromLinear(double c)
+{
+  return (c <= 0.0031308 ? 12.92*c : 1.055*std::pow(c, 1.0/2.4) - 0.055);
+}
+
+double
+toLinearWCAG(double c)
+{
+  return (c <= 0.03928 ? c/12.92 : std::pow((c + 0.055)/1.055, 2.4));
+}
+
+const float *
+toLinearTable()
+{
+  static std::vector<float> table = []() {
+    std::vector<float> table1(256);
+
+    for (int i = 0; i < 256; ++i)
+      table1[i] = float(toLinear(i/255.0));
+
+    return table1;
+  }();
+
+  return &table[0];
+}
+
+const double *
+toLinearWCAGTable()
+{
+  static std::vector<double> table = []() {
+    std::vector<double> table1(256);
+
+    for (int i = 0; i < 256; ++i)
+      table1[i] = toLinearWCAG(i/255.0);
+
+    return table1;
+  }();
+
+  return &table[0];
+}
+
+}
@@ -1,4 +1,10 @@
 #include <CQColorSelector.h>
+#include <CQColorEyedropper.h>
+#include <CQColorPalette.h>
+#include <CQColorContrast.h>
+#include <CQColorHSL.h>
+#include <CQColorSelectorPool.h>
+#include <CQColorRenderCache.h>
 #include <QTabWidget>
 #include <QHBoxLayout>
 #include <QVBoxLayout>
@@ -9,7 +15,20 @@
 #include <QPainter>
 #include <QPainterPath>
 #include <QMouseEvent>
+#include <QWheelEvent>
+#include <QKeyEvent>
+#include <QTabletEvent>
+#include <QFileDialog>
+#include <QMenu>
+#include <QActionGroup>
+#include <QShortcut>
+#include <QTimer>
 #include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <type_traits>
+#include <cstring>
+#include <cctype>
 #include <cmath>
 
 namespace {
@@ -40,7 +59,11 @@ QColor toBW(const QColor &c) {
   return (g < 128 ? QColor(255, 255, 255) : QColor(0, 0, 0));
 }
 
-void paintCheckerboard(QPainter *p, int px, int py, int pw, int ph, int s) {
+QImage renderCheckerboard(int pw, int ph, int s) {
+  QImage image(pw, ph, QImage::Format_RGB32);
+
+  QPainter p(&image);
+
   int h = ph/s; h += (ph % s == 0 ? 0 : 1);
   int w = pw/s; w += (pw % s == 0 ? 0 : 1);
 
@@ -48,9 +71,274 @@ void paintCheckerboard(QPainter *p, int px, int py, int pw, int ph, int s) {
     for (int x = 0; x < w; ++x) {
       QColor c = (((x + y) & 1) ? QColor(96, 96, 96) : QColor(160, 160, 160));
 
-      p->fillRect(QRect(px + s*x, py + s*y, s, s), QBrush(c));
+      p.fillRect(QRect(s*x, s*y, s, s), QBrush(c));
+    }
+  }
+
+  return image;
+}
+
+void paintCheckerboard(QPainter *p, int px, int py, int pw, int ph, int s) {
+  if (pw <= 0 || ph <= 0)
+    return;
+
+  CQColorRenderCache::Key key(CQColorRenderCache::Kind::CHECKERBOARD, QSize(pw, ph),
+                              1.0, uint64_t(s));
+
+  p->drawImage(px, py, CQColorRenderCache::instance()->image(key, [&]() {
+    return renderCheckerboard(pw, ph, s);
+  }));
+}
+
+//---
+
+// get changed components (CQColorSelector::Component bits) between colors
+uint changedComponents(const QColor &c1, const QColor &c2) {
+  uint components = 0;
+
+  auto check = [&](bool changed, uint component) {
+    if (changed) components |= component;
+  };
+
+  check(c1.red  () != c2.red  (), CQColorSelector::RED  );
+  check(c1.green() != c2.green(), CQColorSelector::GREEN);
+  check(c1.blue () != c2.blue (), CQColorSelector::BLUE );
+  check(c1.alpha() != c2.alpha(), CQColorSelector::ALPHA);
+
+  check(c1.hslHueF       () != c2.hslHueF       (), CQColorSelector::HUE       );
+  check(c1.hslSaturationF() != c2.hslSaturationF(), CQColorSelector::SATURATION);
+  check(c1.lightnessF    () != c2.lightnessF    (), CQColorSelector::LIGHTNESS );
+
+  check(c1.cyanF   () != c2.cyanF   (), CQColorSelector::CYAN   );
+  check(c1.magentaF() != c2.magentaF(), CQColorSelector::MAGENTA);
+  check(c1.yellowF () != c2.yellowF (), CQColorSelector::YELLOW );
+  check(c1.blackF  () != c2.blackF  (), CQColorSelector::BLACK  );
+
+  return components;
+}
+
+//---
+
+// batch color conversion on channel arrays (branch free inner loops)
+
+struct ColorArrays {
+  ColorArrays(int n) : r(n), g(n), b(n), a(n) { }
+
+  int size() const { return int(r.size()); }
+
+  std::vector<float> r, g, b, a;
+};
+
+ColorArrays toArrays(const CQColorSelector::Colors &colors) {
+  ColorArrays arrays(int(colors.size()));
+
+  for (int i = 0; i < arrays.size(); ++i) {
+    QRgb rgb = colors[i].rgba();
+
+    arrays.r[i] = qRed  (rgb)/255.0f;
+    arrays.g[i] = qGreen(rgb)/255.0f;
+    arrays.b[i] = qBlue (rgb)/255.0f;
+    arrays.a[i] = qAlpha(rgb)/255.0f;
+  }
+
+  return arrays;
+}
+
+CQColorSelector::Colors fromArrays(const ColorArrays &arrays) {
+  CQColorSelector::Colors colors(arrays.size());
+
+  auto toByte = [](float v) { return int(std::min(std::max(v, 0.0f), 1.0f)*255.0f + 0.5f); };
+
+  for (int i = 0; i < arrays.size(); ++i)
+    colors[i] = QColor(toByte(arrays.r[i]), toByte(arrays.g[i]),
+                       toByte(arrays.b[i]), toByte(arrays.a[i]));
+
+  return colors;
+}
+
+void rgbToHsl(int n, const float *r, const float *g, const float *b,
+              float *h, float *s, float *l) {
+  for (int i = 0; i < n; ++i) {
+    float max = std::max(std::max(r[i], g[i]), b[i]);
+    float min = std::min(std::min(r[i], g[i]), b[i]);
+    float d   = max - min;
+    float id  = (d > 0.0f ? 1.0f/d : 0.0f);
+
+    float hr = (g[i] - b[i])*id;
+    float hg = (b[i] - r[i])*id + 2.0f;
+    float hb = (r[i] - g[i])*id + 4.0f;
+
+    float h1 = (max == r[i] ? hr : (max == g[i] ? hg : hb));
+
+    h1 = (h1 < 0.0f ? h1 + 6.0f : h1);
+
+    l[i] = (max + min)/2.0f;
+
+    float sd = 1.0f - std::fabs(2.0f*l[i] - 1.0f);
+
+    s[i] = (sd > 0.0f ? d/sd : 0.0f);
+    h[i] = h1/6.0f;
+  }
+}
+
+void hslToRgb(int n, const float *h, const float *s, const float *l,
+              float *r, float *g, float *b) {
+  auto f = [](float h1, float s1, float l1, float n1) {
+    float k  = std::fmod(n1 + h1*12.0f, 12.0f);
+    float a1 = s1*std::min(l1, 1.0f - l1);
+
+    return l1 - a1*std::max(-1.0f, std::min(std::min(k - 3.0f, 9.0f - k), 1.0f));
+  };
+
+  for (int i = 0; i < n; ++i) {
+    r[i] = f(h[i], s[i], l[i], 0.0f);
+    g[i] = f(h[i], s[i], l[i], 8.0f);
+    b[i] = f(h[i], s[i], l[i], 4.0f);
+  }
+}
+
+void rgbToCmyk(int n, const float *r, const float *g, const float *b,
+               float *c, float *m, float *y, float *k) {
+  for (int i = 0; i < n; ++i) {
+    k[i] = 1.0f - std::max(std::max(r[i], g[i]), b[i]);
+
+    float ik = (k[i] < 1.0f ? 1.0f/(1.0f - k[i]) : 0.0f);
+
+    c[i] = (1.0f - r[i] - k[i])*ik;
+    m[i] = (1.0f - g[i] - k[i])*ik;
+    y[i] = (1.0f - b[i] - k[i])*ik;
+  }
+}
+
+void cmykToRgb(int n, const float *c, const float *m, const float *y, const float *k,
+               float *r, float *g, float *b) {
+  for (int i = 0; i < n; ++i) {
+    r[i] = (1.0f - c[i])*(1.0f - k[i]);
+    g[i] = (1.0f - m[i])*(1.0f - k[i]);
+    b[i] = (1.0f - y[i])*(1.0f - k[i]);
+  }
+}
+
+inline float clampF(float v) {
+  return std::min(std::max(v, 0.0f), 1.0f);
+}
+
+// add delta to values
+void addDelta(std::vector<float> &v, float d) {
+  for (auto &v1 : v)
+    v1 = clampF(v1 + d);
+}
+
+// scale values by ratio of new/old (add delta if old is zero)
+void scaleDelta(std::vector<float> &v, float oldValue, float newValue) {
+  if (oldValue <= 1E-4f)
+    return addDelta(v, newValue - oldValue);
+
+  float f = newValue/oldValue;
+
+  for (auto &v1 : v)
+    v1 = clampF(v1*f);
+}
+
+// get color channel value (0-1)
+float channelValue(const QColor &c, CQColorSelector::ColorType type) {
+  using ColorType = CQColorSelector::ColorType;
+
+  double h, s, l, a;
+  double cc, m, y, k;
+
+  switch (type) {
+    case ColorType::RGB_R : return float(c.redF  ());
+    case ColorType::RGB_G : return float(c.greenF());
+    case ColorType::RGB_B : return float(c.blueF ());
+    case ColorType::ALPHA : return float(c.alphaF());
+    case ColorType::HSL_H : c.getHslF(&h, &s, &l, &a); return float(std::max(h, 0.0));
+    case ColorType::HSL_S : c.getHslF(&h, &s, &l, &a); return float(s);
+    case ColorType::HSL_L : c.getHslF(&h, &s, &l, &a); return float(l);
+    case ColorType::CMYK_C: c.getCmykF(&cc, &m, &y, &k, &a); return float(cc);
+    case ColorType::CMYK_M: c.getCmykF(&cc, &m, &y, &k, &a); return float(m);
+    case ColorType::CMYK_Y: c.getCmykF(&cc, &m, &y, &k, &a); return float(y);
+    case ColorType::CMYK_K: c.getCmykF(&cc, &m, &y, &k, &a); return float(k);
+    default               : return 0.0f;
+  }
+}
+
+// apply channel changes from oldColor to newColor to colors
+CQColorSelector::Colors
+batchAdjust(const CQColorSelector::Colors &colors, const QColor &oldColor,
+            const QColor &newColor, const std::vector<CQColorSelector::ColorType> &types) {
+  using ColorType = CQColorSelector::ColorType;
+
+  auto arrays = toArrays(colors);
+
+  int n = arrays.size();
+
+  auto hasType = [&](ColorType type) {
+    return (std::find(types.begin(), types.end(), type) != types.end());
+  };
+
+  auto oldValue = [&](ColorType type) { return channelValue(oldColor, type); };
+  auto newValue = [&](ColorType type) { return channelValue(newColor, type); };
+
+  //---
+
+  // rgb (add) and alpha (scale)
+  if (hasType(ColorType::RGB_R))
+    addDelta(arrays.r, newValue(ColorType::RGB_R) - oldValue(ColorType::RGB_R));
+  if (hasType(ColorType::RGB_G))
+    addDelta(arrays.g, newValue(ColorType::RGB_G) - oldValue(ColorType::RGB_G));
+  if (hasType(ColorType::RGB_B))
+    addDelta(arrays.b, newValue(ColorType::RGB_B) - oldValue(ColorType::RGB_B));
+
+  if (hasType(ColorType::ALPHA))
+    scaleDelta(arrays.a, oldValue(ColorType::ALPHA), newValue(ColorType::ALPHA));
+
+  //---
+
+  // hsl (add hue with wrap, scale saturation and lightness)
+  if (hasType(ColorType::HSL_H) || hasType(ColorType::HSL_S) || hasType(ColorType::HSL_L)) {
+    std::vector<float> h(n), s(n), l(n);
+
+    rgbToHsl(n, &arrays.r[0], &arrays.g[0], &arrays.b[0], &h[0], &s[0], &l[0]);
+
+    if (hasType(ColorType::HSL_H)) {
+      float dh = newValue(ColorType::HSL_H) - oldValue(ColorType::HSL_H);
+
+      for (auto &h1 : h) {
+        h1 = std::fmod(h1 + dh + 1.0f, 1.0f);
+      }
     }
+
+    if (hasType(ColorType::HSL_S))
+      scaleDelta(s, oldValue(ColorType::HSL_S), newValue(ColorType::HSL_S));
+    if (hasType(ColorType::HSL_L))
+      scaleDelta(l, oldValue(ColorType::HSL_L), newValue(ColorType::HSL_L));
+
+    hslToRgb(n, &h[0], &s[0], &l[0], &arrays.r[0], &arrays.g[0], &arrays.b[0]);
   }
+
+  //---
+
+  // cmyk (add)
+  if (hasType(ColorType::CMYK_C) || hasType(ColorType::CMYK_M) ||
+      hasType(ColorType::CMYK_Y) || hasType(ColorType::CMYK_K)) {
+    std::vector<float> c(n), m(n), y(n), k(n);
+
+    rgbToCmyk(n, &arrays.r[0], &arrays.g[0], &arrays.b[0], &c[0], &m[0], &y[0], &k[0]);
+
+    if (hasType(ColorType::CMYK_C))
+      addDelta(c, newValue(ColorType::CMYK_C) - oldValue(ColorType::CMYK_C));
+    if (hasType(ColorType::CMYK_M))
+      addDelta(m, newValue(ColorType::CMYK_M) - oldValue(ColorType::CMYK_M));
+    if (hasType(ColorType::CMYK_Y))
+      addDelta(y, newValue(ColorType::CMYK_Y) - oldValue(ColorType::CMYK_Y));
+    if (hasType(ColorType::CMYK_K))
+      addDelta(k, newValue(ColorType::CMYK_K) - oldValue(ColorType::CMYK_K));
+
+    cmykToRgb(n, &c[0], &m[0], &y[0], &k[0], &arrays.r[0], &arrays.g[0], &arrays.b[0]);
+  }
+
+  return fromArrays(arrays);
 }
 
 }
@@ -71,6 +359,69 @@ class CQColorLabel : public QLabel {
 
 //---
 
+CQColorHistory::
+CQColorHistory(int capacity) :
+ rgbs_(std::max(capacity, 2))
+{
+}
+
+void
+CQColorHistory::
+clear(QRgb rgb)
+{
+  start_ = 0;
+  size_  = 1;
+  pos_   = 0;
+
+  rgbs_[0] = rgb;
+}
+
+bool
+CQColorHistory::
+push(QRgb rgb)
+{
+  if (pos_ >= 0 && current() == rgb)
+    return false;
+
+  // remove redo entries
+  size_ = pos_ + 1;
+
+  // drop oldest if full
+  if (size_ == capacity()) {
+    start_ = (start_ + 1) % capacity();
+
+    --size_;
+  }
+
+  rgbs_[(start_ + size_) % capacity()] = rgb;
+
+  pos_ = size_++;
+
+  return true;
+}
+
+QRgb
+CQColorHistory::
+undo()
+{
+  if (canUndo())
+    --pos_;
+
+  return current();
+}
+
+QRgb
+CQColorHistory::
+redo()
+{
+  if (canRedo())
+    ++pos_;
+
+  return current();
+}
+
+//---
+
 CQColorSelector::
 CQColorSelector(QWidget *parent, const Config &config) :
  QWidget(parent), mode_(ColorMode::RGB), config_(config)
@@ -105,7 +456,23 @@ CQColorSelector(QWidget *parent, const Config &config) :
 
   //---
 
-  if (config_.colorButton || config_.colorEdit) {
+  if (config_.palette) {
+    swatches_ = new CQColorSwatches(this);
+
+    swatches_->setVisible(false);
+
+    layout->addWidget(swatches_);
+
+    preview_ = new CQColorImagePreview(this);
+
+    preview_->setVisible(false);
+
+    layout->addWidget(preview_);
+  }
+
+  //---
+
+  if (config_.colorButton || config_.colorEdit || config_.eyedropper || config_.palette) {
     auto *llayout = new QHBoxLayout;
 
     if (config_.colorButton) {
@@ -114,8 +481,32 @@ CQColorSelector(QWidget *parent, const Config &config) :
       llayout->addWidget(colorButton_);
     }
 
+    if (config_.eyedropper) {
+      eyedropperButton_ = new QToolButton;
+      eyedropperButton_->setObjectName("eyedropper");
+      eyedropperButton_->setText("Pick");
+      eyedropperButton_->setToolTip("Pick color from screen");
+
+      llayout->addWidget(eyedropperButton_);
+    }
+
+    if (config_.palette) {
+      imageButton_ = new QToolButton;
+      imageButton_->setObjectName("image");
+      imageButton_->setText("Image...");
+      imageButton_->setToolTip("Extract palette from image");
+
+      llayout->addWidget(imageButton_);
+    }
+
     llayout->addStretch();
 
+    contrastLabel_ = new QLabel;
+    contrastLabel_->setObjectName("contrast");
+    contrastLabel_->setVisible(false);
+
+    llayout->addWidget(contrastLabel_);
+
     if (config_.colorEdit) {
       colorEdit_ = new CQColorEdit(this, c_);
 
@@ -128,21 +519,52 @@ CQColorSelector(QWidget *parent, const Config &config) :
 
   //---
 
-  setColor(c_);
+  updateWidgets();
+
+  history_.clear(c_.rgba());
 
   //---
 
   connect(tab_, SIGNAL(currentChanged(int)), this, SLOT(tabChanged(int)));
 
+  auto *undoShortcut = new QShortcut(QKeySequence::Undo, this, SLOT(undo()));
+  auto *redoShortcut = new QShortcut(QKeySequence::Redo, this, SLOT(redo()));
+
+  undoShortcut->setContext(Qt::WidgetWithChildrenShortcut);
+  redoShortcut->setContext(Qt::WidgetWithChildrenShortcut);
+
   if (colorEdit_)
     connect(colorEdit_, SIGNAL(colorChanged(const QColor &)),
-            this, SLOT(setColor(const QColor &)));
+            this, SLOT(applyColorSlot(const QColor &)));
+
+  if (eyedropperButton_)
+    connect(eyedropperButton_, SIGNAL(clicked()), this, SLOT(eyedropperSlot()));
+
+  if (imageButton_)
+    connect(imageButton_, SIGNAL(clicked()), this, SLOT(loadImageSlot()));
+
+  if (swatches_)
+    connect(swatches_, SIGNAL(colorPressed(const QColor &)),
+            this, SLOT(applyColorSlot(const QColor &)));
 }
 
 QWidget *
 CQColorSelector::
 createRGBTab()
 {
+  if (config_.compact) {
+    ChannelNames channels = { {"R", ColorType::RGB_R}, {"G", ColorType::RGB_G}, {"B", ColorType::RGB_B} };
+
+    if (config_.alpha)
+      channels.push_back({"A", ColorType::ALPHA});
+
+    rgbw_.panel = createPanel("rgb", channels);
+
+    return rgbw_.panel;
+  }
+
+  //---
+
   auto *tab = new QWidget;
   tab->setObjectName("rgb");
 
@@ -181,6 +603,19 @@ QWidget *
 CQColorSelector::
 createHSLTab()
 {
+  if (config_.compact) {
+    ChannelNames channels = { {"H", ColorType::HSL_H}, {"S", ColorType::HSL_S}, {"L", ColorType::HSL_L} };
+
+    if (config_.alpha)
+      channels.push_back({"A", ColorType::ALPHA});
+
+    hslw_.panel = createPanel("hsl", channels);
+
+    return hslw_.panel;
+  }
+
+  //---
+
   auto *tab = new QWidget;
   tab->setObjectName("hsl");
 
@@ -219,6 +654,19 @@ QWidget *
 CQColorSelector::
 createCMYKTab()
 {
+  if (config_.compact) {
+    ChannelNames channels = { {"C", ColorType::CMYK_C}, {"M", ColorType::CMYK_M}, {"Y", ColorType::CMYK_Y}, {"K", ColorType::CMYK_K} };
+
+    if (config_.alpha)
+      channels.push_back({"A", ColorType::ALPHA});
+
+    cmykw_.panel = createPanel("cmyk", channels);
+
+    return cmykw_.panel;
+  }
+
+  //---
+
   auto *tab = new QWidget;
   tab->setObjectName("cmyk");
 
@@ -268,7 +716,11 @@ createWheelTab()
 
   layout->addWidget(wheel_.wheel);
 
-  if (config_.alpha) {
+  if      (config_.alpha && config_.compact) {
+    layout->addWidget(wheel_.panel = createPanel("alpha", {{"A", ColorType::ALPHA}}),
+                      0, Qt::AlignTop);
+  }
+  else if (config_.alpha) {
     auto *alayout = new QGridLayout; alayout->setSpacing(2);
 
     alayout->addWidget(new CQColorLabel("A"), 0, 0);
@@ -286,58 +738,109 @@ void
 CQColorSelector::
 setColor(const QColor &c)
 {
+  // no change (widgets already show color). Compare components as QColor::operator==
+  // also compares spec (e.g. same rgb set from HSL spin box) but include HSL hue and
+  // saturation as hue of a gray (HSL spec) changes but rgb does not
+  uint components = changedComponents(c_, c);
+
+  if (c.isValid() == c_.isValid() && components == 0)
+    return;
+
   c_ = c;
 
+  updateWidgets();
+
   //---
 
+  // add to history unless part of interaction (added at end) or undo/redo
+  if (! applyingHistory_ && interactionDepth_ == 0)
+    history_.push(c_.rgba());
+
+  //---
+
+  emit colorChanged(c_);
+
+  if (asyncPreview_)
+    asyncPreview_->request(c_);
+
+  emit componentsChanged(components);
+
+  if (components & HUE)
+    emit hueChanged(std::max(c_.hslHueF(), 0.0));
+
+  if (components & ALPHA)
+    emit alphaChanged(c_.alpha());
+
+  if (harmonyMode_ != HarmonyMode::NONE)
+    emit harmonyColorsChanged(harmonyColors());
+}
+
+void
+CQColorSelector::
+updateWidgets()
+{
+  // widget updates (e.g. spin values) must not feed back into color
+  bool updating = updating_;
+
+  updating_ = true;
+
   if      (mode_ == ColorMode::RGB) {
+    if (rgbw_.panel)
+      rgbw_.panel->update();
+
     if (rgbw_.rcanvas) {
-      rgbw_.rcanvas->update();
-      rgbw_.gcanvas->update();
-      rgbw_.bcanvas->update();
+      rgbw_.rcanvas->updateColor();
+      rgbw_.gcanvas->updateColor();
+      rgbw_.bcanvas->updateColor();
 
       rgbw_.rspin->setValue(c_.red  ());
       rgbw_.gspin->setValue(c_.green());
       rgbw_.bspin->setValue(c_.blue ());
 
       if (rgbw_.acanvas) {
-        rgbw_.acanvas->update();
+        rgbw_.acanvas->updateColor();
 
         rgbw_.aspin->setValue(c_.alpha());
       }
     }
   }
   else if (mode_ == ColorMode::HSL) {
+    if (hslw_.panel)
+      hslw_.panel->update();
+
     if (hslw_.hcanvas) {
       double h, s, l, a;
 
       c_.getHslF(&h, &s, &l, &a);
 
-      hslw_.hcanvas->update();
-      hslw_.scanvas->update();
-      hslw_.lcanvas->update();
+      hslw_.hcanvas->updateColor();
+      hslw_.scanvas->updateColor();
+      hslw_.lcanvas->updateColor();
 
       hslw_.hspin->setValue(imap(h, 0, 1, 0, 255));
       hslw_.sspin->setValue(imap(s, 0, 1, 0, 255));
       hslw_.lspin->setValue(imap(l, 0, 1, 0, 255));
 
       if (hslw_.acanvas) {
-        hslw_.acanvas->update();
+        hslw_.acanvas->updateColor();
 
         hslw_.aspin->setValue(imap(a, 0, 1, 0, 255));
       }
     }
   }
   else if (mode_ == ColorMode::CMYK) {
+    if (cmykw_.panel)
+      cmykw_.panel->update();
+
     if (cmykw_.ccanvas) {
       double c, m, y, k, a;
 
       c_.getCmykF(&c, &m, &y, &k, &a);
 
-      cmykw_.ccanvas->update();
-      cmykw_.mcanvas->update();
-      cmykw_.ycanvas->update();
-      cmykw_.kcanvas->update();
+      cmykw_.ccanvas->updateColor();
+      cmykw_.mcanvas->updateColor();
+      cmykw_.ycanvas->updateColor();
+      cmykw_.kcanvas->updateColor();
 
       cmykw_.cspin->setValue(imap(c, 0, 1, 0, 255));
       cmykw_.mspin->setValue(imap(m, 0, 1, 0, 255));
@@ -345,7 +848,7 @@ setColor(const QColor &c)
       cmykw_.kspin->setValue(imap(k, 0, 1, 0, 255));
 
       if (cmykw_.acanvas) {
-        cmykw_.acanvas->update();
+        cmykw_.acanvas->updateColor();
 
         cmykw_.aspin->setValue(imap(a, 0, 1, 0, 255));
       }
@@ -357,10 +860,13 @@ setColor(const QColor &c)
 
       c_.getHslF(&h, &s, &l, &a);
 
-      wheel_.wheel->update();
+      wheel_.wheel->updateColor();
+
+      if (wheel_.panel)
+        wheel_.panel->update();
 
       if (wheel_.acanvas) {
-        wheel_.acanvas->update();
+        wheel_.acanvas->updateColor();
 
         wheel_.aspin->setValue(imap(a, 0, 1, 0, 255));
       }
@@ -375,741 +881,2894 @@ setColor(const QColor &c)
   if (colorEdit_)
     colorEdit_->setColor(c_);
 
-  //---
+  if (contrastLabel_ && hasReferenceColor())
+    contrastLabel_->setText(QString("%1:1 Lc %2").
+      arg(contrastRatio(), 0, 'f', 2).arg(apcaContrast(), 0, 'f', 0));
 
-  emit colorChanged(c_);
+  updating_ = updating;
 }
 
 void
 CQColorSelector::
-setColorType(ColorType type, int v)
+setHarmonyMode(HarmonyMode mode)
 {
-  v = int(clamp(v, 0, 255));
+  if (mode == harmonyMode_)
+    return;
 
-  double rv = map(v, 0, 255, 0, 1);
+  harmonyMode_ = mode;
 
-  auto qc = this->color();
+  // only overlay changes
+  if (wheel_.wheel)
+    wheel_.wheel->updateColor();
 
-  if      (type == ColorType::RGB_R) {
-    qc.setRed(v);
-  }
-  else if (type == ColorType::RGB_G) {
-    qc.setGreen(v);
-  }
-  else if (type == ColorType::RGB_B) {
-    qc.setBlue(v);
-  }
-  else if (type == ColorType::HSL_H) {
-    double h, s, l, a;
+  emit harmonyColorsChanged(harmonyColors());
+}
 
-    qc.getHslF(&h, &s, &l, &a);
+void
+CQColorSelector::
+setHarmonySpread(double r)
+{
+  r = clamp(r, 0.0, 0.5);
 
-    qc.setHslF(rv, s, l, a);
-  }
-  else if (type == ColorType::HSL_S) {
-    double h, s, l, a;
+  if (r == harmonySpread_)
+    return;
 
-    qc.getHslF(&h, &s, &l, &a);
+  harmonySpread_ = r;
 
-    qc.setHslF(h, rv, l, a);
-  }
-  else if (type == ColorType::HSL_L) {
-    double h, s, l, a;
+  if (harmonyMode_ != HarmonyMode::ANALOGOUS &&
+      harmonyMode_ != HarmonyMode::SPLIT_COMPLEMENTARY)
+    return;
 
-    qc.getHslF(&h, &s, &l, &a);
+  if (wheel_.wheel)
+    wheel_.wheel->updateColor();
 
-    qc.setHslF(h, s, rv, a);
+  emit harmonyColorsChanged(harmonyColors());
+}
+
+std::vector<double>
+CQColorSelector::
+harmonyHues() const
+{
+  // achromatic colors have hue -1
+  double h = std::max(c_.hslHueF(), 0.0);
+
+  std::vector<double> offsets;
+
+  switch (harmonyMode_) {
+    case HarmonyMode::COMPLEMENTARY:
+      offsets = { 0.5 };
+      break;
+    case HarmonyMode::TRIAD:
+      offsets = { 1.0/3.0, 2.0/3.0 };
+      break;
+    case HarmonyMode::ANALOGOUS:
+      offsets = { -harmonySpread_, harmonySpread_ };
+      break;
+    case HarmonyMode::SPLIT_COMPLEMENTARY:
+      offsets = { 0.5 - harmonySpread_, 0.5 + harmonySpread_ };
+      break;
+    case HarmonyMode::TETRAD:
+      offsets = { 0.25, 0.5, 0.75 };
+      break;
+    default:
+      break;
   }
-  else if (type == ColorType::CMYK_C) {
-    double c, m, y, k, a;
 
-    qc.getCmykF(&c, &m, &y, &k, &a);
+  std::vector<double> hues;
 
-    qc.setCmykF(rv, m, y, k, a);
-  }
-  else if (type == ColorType::CMYK_M) {
-    double c, m, y, k, a;
+  hues.push_back(h);
 
-    qc.getCmykF(&c, &m, &y, &k, &a);
+  for (const auto &o : offsets) {
+    double h1 = std::fmod(h + o, 1.0);
 
-    qc.setCmykF(c, rv, y, k, a);
+    if (h1 < 0.0) h1 += 1.0;
+
+    hues.push_back(h1);
   }
-  else if (type == ColorType::CMYK_Y) {
-    double c, m, y, k, a;
 
-    qc.getCmykF(&c, &m, &y, &k, &a);
+  return hues;
+}
 
-    qc.setCmykF(c, m, rv, k, a);
-  }
-  else if (type == ColorType::CMYK_K) {
-    double c, m, y, k, a;
+CQColorSelector::Colors
+CQColorSelector::
+harmonyColors() const
+{
+  double h, s, l, a;
 
-    qc.getCmykF(&c, &m, &y, &k, &a);
+  c_.getHslF(&h, &s, &l, &a);
 
-    qc.setCmykF(c, m, y, rv, a);
-  }
-  else if (type == ColorType::ALPHA) {
-    qc.setAlpha(v);
-  }
+  auto hues = harmonyHues();
 
-  this->setColor(qc);
-}
+  Colors colors;
 
-void
-CQColorSelector::
-tabChanged(int i)
-{
-  if      (tab_->tabText(i) == "RGB"  ) mode_ = ColorMode::RGB;
-  else if (tab_->tabText(i) == "HSL"  ) mode_ = ColorMode::HSL;
-  else if (tab_->tabText(i) == "CMYK" ) mode_ = ColorMode::CMYK;
-  else if (tab_->tabText(i) == "Wheel") mode_ = ColorMode::WHEEL;
+  colors.push_back(c_);
+
+  for (int i = 1; i < int(hues.size()); ++i)
+    colors.push_back(QColor::fromHslF(hues[i], s, l, a));
 
-  setColor(c_);
+  return colors;
 }
 
-QSize
+void
 CQColorSelector::
-sizeHint() const
+dragHarmony(int i, double hue)
 {
-  return tab_->sizeHint();
-  //return QSize(250, 200);
-}
+  auto hues = harmonyHues();
 
-//------
+  if (i <= 0 || i >= int(hues.size()))
+    return;
 
-namespace {
-void drawIndicatorUp(QPainter *p, int x, int y) {
-  p->setRenderHint(QPainter::Antialiasing);
+  // hue difference from base in range (-0.5, 0.5]
+  auto hueDelta = [](double h1, double h2) {
+    double d = std::fmod(h1 - h2, 1.0);
 
-  int x1 = x - 4;
-  int x2 = x + 4;
-  int y1 = y;
-  int y2 = y - 4;
+    if (d <= -0.5) d += 1.0;
+    if (d >   0.5) d -= 1.0;
 
-  QPainterPath path;
+    return d;
+  };
 
-  path.moveTo(x1, y1);
-  path.lineTo(x , y2);
-  path.lineTo(x2, y1);
+  if      (harmonyMode_ == HarmonyMode::ANALOGOUS) {
+    // change spread (only overlay redrawn)
+    setHarmonySpread(std::fabs(hueDelta(hue, hues[0])));
+  }
+  else if (harmonyMode_ == HarmonyMode::SPLIT_COMPLEMENTARY) {
+    setHarmonySpread(std::fabs(hueDelta(hue, std::fmod(hues[0] + 0.5, 1.0))));
+  }
+  else {
+    // rotate base hue so dragged hue follows mouse
+    double h = std::fmod(hue - hueDelta(hues[i], hues[0]) + 1.0, 1.0);
 
-  path.closeSubpath();
+    double h1, s, l, a;
 
-  p->setPen(QColor(255, 255, 255));
-  p->setBrush(QColor(0, 0, 0));
+    c_.getHslF(&h1, &s, &l, &a);
 
-  p->drawPath(path);
+    setColorChannels(QColor::fromHslF(h, s, l, a), { ColorType::HSL_H });
+  }
 }
 
-void drawIndicatorDown(QPainter *p, int x, int y) {
-  p->setRenderHint(QPainter::Antialiasing);
+void
+CQColorSelector::
+setCvdType(CQColorCVD::Type type)
+{
+  if (type == cvdType_)
+    return;
 
-  int x1 = x - 4;
-  int x2 = x + 4;
-  int y1 = y;
-  int y2 = y + 4;
+  cvdType_ = type;
 
-  QPainterPath path;
+  //---
 
-  path.moveTo(x1, y1);
-  path.lineTo(x , y2);
-  path.lineTo(x2, y1);
+  for (auto *gradient : gradients())
+    gradient->update();
 
-  path.closeSubpath();
+  for (auto *panel : panels())
+    panel->update();
 
-  p->setPen(QColor(255, 255, 255));
-  p->setBrush(QColor(0, 0, 0));
+  if (wheel_.wheel)
+    wheel_.wheel->clearCache();
 
-  p->drawPath(path);
-}
+  if (colorButton_)
+    colorButton_->update();
 
-void drawIndicators(QPainter *p, int x, int h) {
-  drawIndicatorUp  (p, x, h - 1);
-  drawIndicatorDown(p, x, 0    );
-}
+  if (swatches_)
+    swatches_->update();
 
-int pixelToColor(int x, int w) {
-  return int(255.0*(1.0*x)/(w - 1) + 0.5);
+  if (preview_)
+    preview_->setColors(preview_->colors());
 }
 
-}
+void
+CQColorSelector::
+setReferenceColor(const QColor &c)
+{
+  referenceColor_ = c;
 
-//------
+  if (contrastLabel_)
+    contrastLabel_->setVisible(hasReferenceColor());
 
-CQColorGradient::
-CQColorGradient(CQColorSelector *stroke, ColorType type) :
- stroke_(stroke), type_(type)
-{
-  setObjectName("gradient");
+  for (auto *gradient : gradients())
+    gradient->update();
 
-  QFontMetrics fm(font());
+  for (auto *panel : panels())
+    panel->update();
 
-  setFixedHeight(fm.height() + 4);
+  if (wheel_.wheel)
+    wheel_.wheel->update();
+
+  updateWidgets();
 }
 
-void
-CQColorGradient::
-mousePressEvent(QMouseEvent *e)
+double
+CQColorSelector::
+contrastRatio() const
 {
-  int v = pixelToColor(e->pos().x(), width());
+  if (! hasReferenceColor())
+    return 1.0;
 
-  stroke_->setColorType(type_, v);
+  return CQColorContrast::contrastRatio(c_, referenceColor_);
 }
 
-void
-CQColorGradient::
-mouseMoveEvent(QMouseEvent *e)
+double
+CQColorSelector::
+apcaContrast() const
 {
-  int v = pixelToColor(e->pos().x(), width());
+  if (! hasReferenceColor())
+    return 0.0;
 
-  stroke_->setColorType(type_, v);
+  return CQColorContrast::apca(c_, referenceColor_);
 }
 
-void
-CQColorGradient::
-mouseReleaseEvent(QMouseEvent *e)
+std::vector<CQColorGradient *>
+CQColorSelector::
+gradients() const
 {
-  int v = pixelToColor(e->pos().x(), width());
+  std::vector<CQColorGradient *> gradients;
 
-  stroke_->setColorType(type_, v);
-}
+  auto add = [&](CQColorGradient *gradient) {
+    if (gradient)
+      gradients.push_back(gradient);
+  };
 
-void
-CQColorGradient::
-paintEvent(QPaintEvent *)
-{
-  QPainter p(this);
+  add(rgbw_.rcanvas); add(rgbw_.gcanvas); add(rgbw_.bcanvas); add(rgbw_.acanvas);
 
-  auto qc = stroke_->color();
+  add(hslw_.hcanvas); add(hslw_.scanvas); add(hslw_.lcanvas); add(hslw_.acanvas);
 
-  int pw = width ();
-  int ph = height();
+  add(cmykw_.ccanvas); add(cmykw_.mcanvas); add(cmykw_.ycanvas); add(cmykw_.kcanvas);
+  add(cmykw_.acanvas);
 
-  if      (type_ == ColorType::RGB_R) {
-    for (int x = 0; x < pw; ++x) {
-      double r = (1.0*x)/(pw - 1);
+  add(wheel_.acanvas);
 
-      QColor c1(int(r*255 + 0.5), qc.green(), qc.blue());
+  return gradients;
+}
 
-      p.setPen(c1);
+std::vector<CQColorChannelPanel *>
+CQColorSelector::
+panels() const
+{
+  std::vector<CQColorChannelPanel *> panels;
 
-      p.drawLine(x, 0, x, ph - 1);
-    }
+  for (auto *panel : { rgbw_.panel, hslw_.panel, cmykw_.panel, wheel_.panel })
+    if (panel)
+      panels.push_back(panel);
 
-    int x = int((qc.red()*(pw - 1.0))/255.0 + 0.5);
+  return panels;
+}
 
-    drawIndicators(&p, x, ph);
-  }
-  else if (type_ == ColorType::RGB_G) {
-    for (int x = 0; x < pw; ++x) {
-      double g = (1.0*x)/(pw - 1);
+CQColorChannelPanel *
+CQColorSelector::
+createPanel(const QString &name, const ChannelNames &channels)
+{
+  CQColorChannelPanel::Channels channels1;
 
-      QColor c1(qc.red(), int(g*255 + 0.5), qc.blue());
+  for (const auto &channel : channels)
+    channels1.push_back(CQColorChannelPanel::Channel(channel.first, channel.second));
 
-      p.setPen(c1);
+  auto *panel = new CQColorChannelPanel(this, channels1);
 
-      p.drawLine(x, 0, x, ph - 1);
-    }
+  panel->setObjectName(name);
 
-    int x = int((qc.green()*(pw - 1.0))/255.0 + 0.5);
+  return panel;
+}
 
-    drawIndicators(&p, x, ph);
-  }
-  else if (type_ == ColorType::RGB_B) {
-    for (int x = 0; x < pw; ++x) {
-      double b = (1.0*x)/(pw - 1);
+QColor
+CQColorSelector::
+displayColor(const QColor &c) const
+{
+  return CQColorCVD::simulate(c, cvdType_);
+}
 
-      QColor c1(qc.red(), qc.green(), int(b*255 + 0.5));
+void
+CQColorSelector::
+setColorType(ColorType type, int v)
+{
+  v = int(clamp(v, 0, 255));
 
-      p.setPen(c1);
+  setColorTypeF(type, map(v, 0, 255, 0, 1));
+}
 
-      p.drawLine(x, 0, x, ph - 1);
-    }
+void
+CQColorSelector::
+setColorTypeF(ColorType type, double rv)
+{
+  rv = clamp(rv, 0.0, 1.0);
 
-    int x = int((qc.blue()*(pw - 1.0))/255.0 + 0.5);
+  auto qc = this->color();
 
-    drawIndicators(&p, x, ph);
+  if      (type == ColorType::RGB_R) {
+    qc.setRedF(rv);
+  }
+  else if (type == ColorType::RGB_G) {
+    qc.setGreenF(rv);
+  }
+  else if (type == ColorType::RGB_B) {
+    qc.setBlueF(rv);
   }
-  else if (type_ == ColorType::HSL_H) {
+  else if (type == ColorType::HSL_H) {
     double h, s, l, a;
 
     qc.getHslF(&h, &s, &l, &a);
 
-    for (int x = 0; x < pw; ++x) {
-      auto c1 = QColor::fromHslF(map(x, 0, pw - 1, 0, 1), 1, 0.5);
-
-      p.setPen(c1);
-
-      p.drawLine(x, 0, x, ph - 1);
-    }
-
-    drawIndicators(&p, imap(h, 0, 1, 0, pw - 1), ph);
+    qc.setHslF(rv, s, l, a);
   }
-  else if (type_ == ColorType::HSL_S) {
+  else if (type == ColorType::HSL_S) {
     double h, s, l, a;
 
     qc.getHslF(&h, &s, &l, &a);
 
-    for (int x = 0; x < pw; ++x) {
-      auto c1 = QColor::fromHslF(h, map(x, 0, pw - 1, 0, 1), l);
-
-      p.setPen(c1);
-
-      p.drawLine(x, 0, x, ph - 1);
-    }
-
-    drawIndicators(&p, imap(s, 0, 1, 0, pw - 1), ph);
+    qc.setHslF(h, rv, l, a);
   }
-  else if (type_ == ColorType::HSL_L) {
+  else if (type == ColorType::HSL_L) {
     double h, s, l, a;
 
     qc.getHslF(&h, &s, &l, &a);
 
-    for (int x = 0; x < pw; ++x) {
-      auto c1 = QColor::fromHslF(h, s, map(x, 0, pw - 1, 0, 1));
-
-      p.setPen(c1);
-
-      p.drawLine(x, 0, x, ph - 1);
-    }
-
-    drawIndicators(&p, imap(l, 0, 1, 0, pw - 1), ph);
+    qc.setHslF(h, s, rv, a);
   }
-  else if (type_ == ColorType::CMYK_C) {
+  else if (type == ColorType::CMYK_C) {
     double c, m, y, k, a;
 
     qc.getCmykF(&c, &m, &y, &k, &a);
 
-    for (int x = 0; x < pw; ++x) {
-      auto c1 = QColor::fromCmykF(map(x, 0, pw - 1, 0, 1), m, y, k);
-
-      p.setPen(c1);
-
-      p.drawLine(x, 0, x, ph - 1);
-    }
-
-    drawIndicators(&p, imap(c, 0, 1, 0, pw - 1), ph);
+    qc.setCmykF(rv, m, y, k, a);
   }
-  else if (type_ == ColorType::CMYK_M) {
+  else if (type == ColorType::CMYK_M) {
     double c, m, y, k, a;
 
     qc.getCmykF(&c, &m, &y, &k, &a);
 
-    for (int x = 0; x < pw; ++x) {
-      auto c1 = QColor::fromCmykF(c, map(x, 0, pw - 1, 0, 1), y, k);
-
-      p.setPen(c1);
-
-      p.drawLine(x, 0, x, ph - 1);
-    }
-
-    drawIndicators(&p, imap(m, 0, 1, 0, pw - 1), ph);
+    qc.setCmykF(c, rv, y, k, a);
   }
-  else if (type_ == ColorType::CMYK_Y) {
+  else if (type == ColorType::CMYK_Y) {
     double c, m, y, k, a;
 
     qc.getCmykF(&c, &m, &y, &k, &a);
 
-    for (int x = 0; x < pw; ++x) {
-      auto c1 = QColor::fromCmykF(c, m, map(x, 0, pw - 1, 0, 1), k);
-
-      p.setPen(c1);
-
-      p.drawLine(x, 0, x, ph - 1);
-    }
-
-    drawIndicators(&p, imap(y, 0, 1, 0, pw - 1), ph);
+    qc.setCmykF(c, m, rv, k, a);
   }
-  else if (type_ == ColorType::CMYK_K) {
+  else if (type == ColorType::CMYK_K) {
     double c, m, y, k, a;
 
     qc.getCmykF(&c, &m, &y, &k, &a);
 
-    for (int x = 0; x < pw; ++x) {
-      auto c1 = QColor::fromCmykF(c, m, y, map(x, 0, pw - 1, 0, 1));
-
-      p.setPen(c1);
-
-      p.drawLine(x, 0, x, ph - 1);
-    }
-
-    drawIndicators(&p, imap(k, 0, 1, 0, pw - 1), ph);
+    qc.setCmykF(c, m, y, rv, a);
+  }
+  else if (type == ColorType::ALPHA) {
+    qc.setAlphaF(rv);
   }
-  else if (type_ == ColorType::ALPHA) {
-    paintCheckerboard(&p, 0, 0, pw, ph, 7);
 
-#if 0
-    int s = 7;
+  setColorChannels(qc, { type });
+}
 
-    int h1 = ph/s; h1 += (ph % s == 0 ? 0 : 1);
-    int w1 = pw/s; w1 += (pw % s == 0 ? 0 : 1);
+void
+CQColorSelector::
+setColorChannels(const QColor &c, const std::vector<ColorType> &types)
+{
+  if (! batch_.empty()) {
+    // during an interaction deltas are relative to colors at start so
+    // clamping/rounding doesn't accumulate
+    bool interaction = (interactionDepth_ > 0 && ! batchBase_.empty());
 
-    for (int y = 0; y < h1; ++y) {
-      for (int x = 0; x < w1; ++x) {
-        auto c1 = (((x + y) & 1) ? QColor(96, 96, 96) : QColor(160, 160, 160));
+    const auto &base      = (interaction ? batchBase_      : batch_);
+    const auto &baseColor = (interaction ? batchBaseColor_ : c_    );
 
-        p.fillRect(QRect(s*x, s*y, s, s), QBrush(c1));
-      }
-    }
-#endif
+    batch_ = batchAdjust(base, baseColor, c, types);
+  }
 
-    for (int x = 0; x < pw; ++x) {
-      double a = (1.0*x)/(pw - 1);
+  setColor(c);
 
-      QColor c1(qc.red(), qc.green(), qc.blue(), int(a*255 + 0.5));
+  if (! batch_.empty())
+    emit colorsChanged(batch_);
+}
 
-      p.setPen(c1);
+void
+CQColorSelector::
+applyColorSlot(const QColor &c)
+{
+  // whole color change moves bound colors by the rgb and alpha change
+  setColorChannels(c, { ColorType::RGB_R, ColorType::RGB_G, ColorType::RGB_B,
+                        ColorType::ALPHA });
+}
 
-      p.drawLine(x, 0, x, ph - 1);
-    }
+void
+CQColorSelector::
+setColors(const Colors &colors)
+{
+  batch_ = colors;
 
-    int x = int((qc.alpha()*(pw - 1.0))/255.0 + 0.5);
+  batchBase_.clear();
 
-    drawIndicators(&p, x, ph);
+  if (interactionDepth_ > 0) {
+    batchBase_      = batch_;
+    batchBaseColor_ = c_;
   }
-}
 
-//------
+  if (! batch_.empty())
+    setColor(batch_[0]);
 
-CQColorSelectorWheel::
-CQColorSelectorWheel(CQColorSelector *stroke) :
- stroke_(stroke), circle_(false), triangle_(false)
-{
-  setObjectName("wheel");
+  emit colorsChanged(batch_);
 }
 
 void
-CQColorSelectorWheel::
-mousePressEvent(QMouseEvent *e)
+CQColorSelector::
+clearColors()
 {
-  circle_   = false;
-  triangle_ = false;
-  pressX_   = e->pos().x();
-  pressY_   = e->pos().y();
+  setColors(Colors());
+}
 
-  if (updateCircle(pressX_, pressY_, true)) {
-    circle_ = true;
-    return;
+void
+CQColorSelector::
+beginInteraction()
+{
+  if (interactionDepth_ == 0 && ! batch_.empty()) {
+    batchBase_      = batch_;
+    batchBaseColor_ = c_;
   }
 
-  if (updateTriangle(pressX_, pressY_, true)) {
-    triangle_ = true;
-    return;
-  }
+  ++interactionDepth_;
 }
 
 void
-CQColorSelectorWheel::
-mouseMoveEvent(QMouseEvent *e)
+CQColorSelector::
+endInteraction()
 {
-  pressX_ = e->pos().x();
-  pressY_ = e->pos().y();
+  if (interactionDepth_ <= 0)
+    return;
 
-  if (circle_)
-    updateCircle(pressX_, pressY_, false);
+  --interactionDepth_;
 
-  if (triangle_)
-    updateTriangle(pressX_, pressY_, false);
+  if (interactionDepth_ == 0) {
+    batchBase_.clear();
+
+    history_.push(c_.rgba());
+  }
 }
 
 void
-CQColorSelectorWheel::
-mouseReleaseEvent(QMouseEvent *e)
+CQColorSelector::
+undo()
 {
-  pressX_ = e->pos().x();
-  pressY_ = e->pos().y();
+  if (! history_.canUndo())
+    return;
 
-  if (circle_)
-    updateCircle(pressX_, pressY_, false);
+  applyingHistory_ = true;
 
-  if (triangle_)
-    updateTriangle(pressX_, pressY_, false);
+  applyColorSlot(QColor::fromRgba(history_.undo()));
+
+  applyingHistory_ = false;
 }
 
-bool
-CQColorSelectorWheel::
-updateCircle(int x, int y, bool checkInside)
+void
+CQColorSelector::
+redo()
 {
-  double y1 = ps_ - 1 - y;
+  if (! history_.canRedo())
+    return;
 
-  double dx = x - xc_;
-  double dy = y1 - yc_;
+  applyingHistory_ = true;
 
-  double r = sqrt(dx*dx + dy*dy);
+  applyColorSlot(QColor::fromRgba(history_.redo()));
 
-  if (checkInside && (r < ri_ || r > ro_)) {
+  applyingHistory_ = false;
+}
+
+void
+CQColorSelector::
+clearHistory()
+{
+  history_.clear(c_.rgba());
+}
+
+bool
+CQColorSelector::
+setMode(ColorMode mode)
+{
+  QString name;
+
+  switch (mode) {
+    case ColorMode::RGB  : name = "RGB"  ; break;
+    case ColorMode::HSL  : name = "HSL"  ; break;
+    case ColorMode::CMYK : name = "CMYK" ; break;
+    case ColorMode::WHEEL: name = "Wheel"; break;
+  }
+
+  for (int i = 0; i < tab_->count(); ++i) {
+    if (tab_->tabText(i) == name) {
+      tab_->setCurrentIndex(i);
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void
+CQColorSelector::
+resetState()
+{
+  // remove hook first so state changes below do not run it
+  setAsyncPreview(CQColorAsyncPreview::Func());
+
+  interactionDepth_ = 0;
+
+  clearColors();
+
+  batchBase_.clear();
+
+  batchBaseColor_ = QColor();
+
+  setHarmonyMode  (HarmonyMode::NONE);
+  setHarmonySpread(1.0/12.0);
+
+  setCvdType(CQColorCVD::Type::NONE);
+
+  setPaletteColors(Colors());
+  setPreviewImage (QImage());
+
+  setReferenceColor(QColor());
+}
+
+void
+CQColorSelector::
+tabChanged(int i)
+{
+  if      (tab_->tabText(i) == "RGB"  ) mode_ = ColorMode::RGB;
+  else if (tab_->tabText(i) == "HSL"  ) mode_ = ColorMode::HSL;
+  else if (tab_->tabText(i) == "CMYK" ) mode_ = ColorMode::CMYK;
+  else if (tab_->tabText(i) == "Wheel") mode_ = ColorMode::WHEEL;
+
+  updateWidgets();
+}
+
+void
+CQColorSelector::
+eyedropperSlot()
+{
+  if (! eyedropper_) {
+    eyedropper_ = new CQColorEyedropper(this);
+
+    connect(eyedropper_, SIGNAL(colorPicked(const QColor &)),
+            this, SLOT(applyColorSlot(const QColor &)));
+  }
+
+  eyedropper_->start();
+}
+
+void
+CQColorSelector::
+setPaletteColors(const Colors &colors)
+{
+  paletteColors_ = colors;
+
+  if (swatches_) {
+    swatches_->setColors(paletteColors_);
+
+    swatches_->setVisible(! paletteColors_.empty());
+  }
+
+  if (preview_) {
+    preview_->setColors(paletteColors_);
+
+    preview_->setVisible(! preview_->image().isNull() && ! paletteColors_.empty());
+  }
+
+  emit paletteChanged();
+}
+
+const QImage &
+CQColorSelector::
+previewImage() const
+{
+  static QImage noImage;
+
+  return (preview_ ? preview_->image() : noImage);
+}
+
+void
+CQColorSelector::
+setPreviewImage(const QImage &image)
+{
+  if (! preview_)
+    return;
+
+  preview_->setImage(image);
+
+  preview_->setVisible(! image.isNull() && ! paletteColors_.empty());
+}
+
+bool
+CQColorSelector::
+isPreviewDither() const
+{
+  return (preview_ ? preview_->isDither() : false);
+}
+
+void
+CQColorSelector::
+setPreviewDither(bool b)
+{
+  if (preview_)
+    preview_->setDither(b);
+}
+
+void
+CQColorSelector::
+extractPalette(const QImage &image, int n)
+{
+  setPaletteColors(CQColorPalette::dominantColors(image, n));
+}
+
+void
+CQColorSelector::
+loadImageSlot()
+{
+  auto filename = QFileDialog::getOpenFileName(this, "Load Image", "",
+                    "Images (*.png *.jpg *.jpeg *.bmp *.gif *.ppm *.xpm)");
+
+  if (filename.isEmpty())
+    return;
+
+  QImage image(filename);
+
+  if (image.isNull())
+    return;
+
+  setPreviewImage(image);
+
+  extractPalette(image);
+}
+
+void
+CQColorSelector::
+setAsyncPreview(const CQColorAsyncPreview::Func &func, int debounce)
+{
+  delete asyncPreview_;
+
+  asyncPreview_ = nullptr;
+
+  if (! func)
+    return;
+
+  asyncPreview_ = new CQColorAsyncPreview(func, debounce, this);
+
+  connect(asyncPreview_, SIGNAL(resultReady(const QColor &, const QVariant &)),
+          this, SIGNAL(previewReady(const QColor &, const QVariant &)));
+
+  asyncPreview_->request(c_);
+}
+
+QSize
+CQColorSelector::
+sizeHint() const
+{
+  return tab_->sizeHint();
+  //return QSize(250, 200);
+}
+
+//------
+
+CQColorInputCompressor::
+CQColorInputCompressor(QWidget *widget, const Func &func) :
+ widget_(widget), func_(func)
+{
+  clock_.start();
+}
+
+void
+CQColorInputCompressor::
+post(const QPointF &p)
+{
+  pos_      = p;
+  pending_  = true;
+  postTime_ = clock_.nsecsElapsed();
+
+  ++numPosted_;
+
+  // apply now if a frame has passed since last apply, otherwise at end of frame
+  int dt = (flushTime_ >= 0 ? int((postTime_ - flushTime_)/1000000) : frameInterval_);
+
+  if (dt >= frameInterval_) {
+    flush();
+    return;
+  }
+
+  if (! scheduled_) {
+    scheduled_ = true;
+
+    QTimer::singleShot(frameInterval_ - dt, widget_, [this]() {
+      scheduled_ = false;
+
+      flush();
+    });
+  }
+}
+
+void
+CQColorInputCompressor::
+flush()
+{
+  if (! pending_)
+    return;
+
+  pending_ = false;
+
+  flushTime_ = clock_.nsecsElapsed();
+
+  ++numApplied_;
+
+  // latency sampled from first applied position the next paint shows
+  if (func_(pos_) && appliedTime_ < 0)
+    appliedTime_ = postTime_;
+}
+
+void
+CQColorInputCompressor::
+painted()
+{
+  if (appliedTime_ < 0)
+    return;
+
+  double latency = double(clock_.nsecsElapsed() - appliedTime_)/1000000.0;
+
+  appliedTime_ = -1;
+
+  ++numLatencies_;
+
+  sumLatency_ += latency;
+  maxLatency_  = std::max(maxLatency_, latency);
+}
+
+void
+CQColorInputCompressor::
+resetStats()
+{
+  numPosted_    = 0;
+  numApplied_   = 0;
+  numLatencies_ = 0;
+  sumLatency_   = 0.0;
+  maxLatency_   = 0.0;
+}
+
+//------
+
+namespace {
+void drawIndicatorUp(QPainter *p, int x, int y) {
+  p->setRenderHint(QPainter::Antialiasing);
+
+  int x1 = x - 4;
+  int x2 = x + 4;
+  int y1 = y;
+  int y2 = y - 4;
+
+  QPainterPath path;
+
+  path.moveTo(x1, y1);
+  path.lineTo(x , y2);
+  path.lineTo(x2, y1);
+
+  path.closeSubpath();
+
+  p->setPen(QColor(255, 255, 255));
+  p->setBrush(QColor(0, 0, 0));
+
+  p->drawPath(path);
+}
+
+void drawIndicatorDown(QPainter *p, int x, int y) {
+  p->setRenderHint(QPainter::Antialiasing);
+
+  int x1 = x - 4;
+  int x2 = x + 4;
+  int y1 = y;
+  int y2 = y + 4;
+
+  QPainterPath path;
+
+  path.moveTo(x1, y1);
+  path.lineTo(x , y2);
+  path.lineTo(x2, y1);
+
+  path.closeSubpath();
+
+  p->setPen(QColor(255, 255, 255));
+  p->setBrush(QColor(0, 0, 0));
+
+  p->drawPath(path);
+}
+
+void drawIndicators(QPainter *p, int x, int h) {
+  drawIndicatorUp  (p, x, h - 1);
+  drawIndicatorDown(p, x, 0    );
+}
+
+int pixelToColor(int x, int w) {
+  return int(255.0*(1.0*x)/(w - 1) + 0.5);
+}
+
+//---
+
+// gradient strip kernels specialized per channel at compile time.
+//
+// A color space defines the number of components, how to get them from a color
+// and how to convert them to rgb. Channel traits select the space and component
+// index, so each kernel is a loop setting one component with no per pixel
+// branching on the channel type.
+
+inline int toByte(double v) {
+  return int(v*255 + 0.5);
+}
+
+struct RGBSpace {
+  static constexpr int N = 4;
+
+  static void get(const QColor &c, double v[N]) {
+    v[0] = c.redF(); v[1] = c.greenF(); v[2] = c.blueF(); v[3] = c.alphaF();
+  }
+
+  static QRgb toRgb(const double v[N]) {
+    return qRgba(toByte(v[0]), toByte(v[1]), toByte(v[2]), toByte(v[3]));
+  }
+};
+
+struct HSLSpace {
+  static constexpr int N = 3;
+
+  static void get(const QColor &c, double v[N]) {
+    double a;
+
+    c.getHslF(&v[0], &v[1], &v[2], &a);
+  }
+
+  static QRgb toRgb(const double v[N]) {
+    return CQColorHSL::toRgb(v[0], v[1], v[2]);
+  }
+};
+
+struct CMYKSpace {
+  static constexpr int N = 4;
+
+  static void get(const QColor &c, double v[N]) {
+    double a;
+
+    c.getCmykF(&v[0], &v[1], &v[2], &v[3], &a);
+  }
+
+  static QRgb toRgb(const double v[N]) {
+    double k1 = 1.0 - v[3];
+
+    return qRgb(toByte((1.0 - v[0])*k1), toByte((1.0 - v[1])*k1), toByte((1.0 - v[2])*k1));
+  }
+};
+
+// space, component index, whether strip is opaque and whether the other components
+// are fixed to full saturation and half lightness (hue strip shows pure hues so it
+// stays usable for gray and low saturation colors)
+template<CQColorSelector::ColorType TYPE>
+struct ChannelTraits;
+
+#define CQ_CHANNEL_TRAITS(TYPE, SPACE, INDEX, OPAQUE, PURE) \
+template<> struct ChannelTraits<CQColorSelector::ColorType::TYPE> { \
+  using Space = SPACE; \
+  static constexpr int  index  = INDEX; \
+  static constexpr bool opaque = OPAQUE; \
+  static constexpr bool pure   = PURE; \
+};
+
+CQ_CHANNEL_TRAITS(RGB_R , RGBSpace , 0, true , false)
+CQ_CHANNEL_TRAITS(RGB_G , RGBSpace , 1, true , false)
+CQ_CHANNEL_TRAITS(RGB_B , RGBSpace , 2, true , false)
+CQ_CHANNEL_TRAITS(HSL_H , HSLSpace , 0, true , true )
+CQ_CHANNEL_TRAITS(HSL_S , HSLSpace , 1, true , false)
+CQ_CHANNEL_TRAITS(HSL_L , HSLSpace , 2, true , false)
+CQ_CHANNEL_TRAITS(CMYK_C, CMYKSpace, 0, true , false)
+CQ_CHANNEL_TRAITS(CMYK_M, CMYKSpace, 1, true , false)
+CQ_CHANNEL_TRAITS(CMYK_Y, CMYKSpace, 2, true , false)
+CQ_CHANNEL_TRAITS(CMYK_K, CMYKSpace, 3, true , false)
+CQ_CHANNEL_TRAITS(ALPHA , RGBSpace , 3, false, false)
+
+#undef CQ_CHANNEL_TRAITS
+
+template<CQColorSelector::ColorType TYPE>
+void stripKernelT(const QColor &qc, QRgb *line, int pw, int &ix) {
+  using Traits = ChannelTraits<TYPE>;
+  using Space  = typename Traits::Space;
+
+  double v[Space::N];
+
+  Space::get(qc, v);
+
+  // opaque rgb strips ignore color alpha
+  if constexpr (Traits::opaque && std::is_same<Space, RGBSpace>::value)
+    v[3] = 1.0;
+
+  // pure hue strip (achromatic hue is -1)
+  if constexpr (Traits::pure) {
+    v[0] = std::max(v[0], 0.0);
+    v[1] = 1.0;
+    v[2] = 0.5;
+  }
+
+  ix = int(v[Traits::index]*(pw - 1.0) + 0.5);
+
+  double dx = (pw > 1 ? 1.0/(pw - 1) : 0.0);
+
+  for (int x = 0; x < pw; ++x) {
+    v[Traits::index] = x*dx;
+
+    line[x] = Space::toRgb(v);
+  }
+}
+
+using StripKernel = void (*)(const QColor &qc, QRgb *line, int pw, int &ix);
+
+StripKernel stripKernel(CQColorSelector::ColorType type) {
+  using ColorType = CQColorSelector::ColorType;
+
+  // indexed by ColorType
+  static const StripKernel kernels[] = {
+    &stripKernelT<ColorType::RGB_R >,
+    &stripKernelT<ColorType::RGB_G >,
+    &stripKernelT<ColorType::RGB_B >,
+    &stripKernelT<ColorType::HSL_H >,
+    &stripKernelT<ColorType::HSL_S >,
+    &stripKernelT<ColorType::HSL_L >,
+    &stripKernelT<ColorType::CMYK_C>,
+    &stripKernelT<ColorType::CMYK_M>,
+    &stripKernelT<ColorType::CMYK_Y>,
+    &stripKernelT<ColorType::CMYK_K>,
+    &stripKernelT<ColorType::ALPHA >
+  };
+
+  static_assert(sizeof(kernels)/sizeof(kernels[0]) == size_t(ColorType::ALPHA) + 1,
+                "kernel table must match ColorType");
+
+  return kernels[int(type)];
+}
+
+// 16 bit value of (0-1) component
+uint64_t component16(double v) {
+  return uint64_t(qRound(std::min(std::max(v, 0.0), 1.0)*65535.0));
+}
+
+// color components a channel strip depends on (all except channel itself)
+uint64_t stripComponents(CQColorSelector::ColorType type, const QColor &c) {
+  using ColorType = CQColorSelector::ColorType;
+
+  auto pack = [](uint64_t v1, uint64_t v2, uint64_t v3) {
+    return (v1 << 32) | (v2 << 16) | v3;
+  };
+
+  double h, s, l, a;
+  double cc, m, y, k;
+
+  switch (type) {
+    case ColorType::RGB_R: return pack(0, c.green(), c.blue ());
+    case ColorType::RGB_G: return pack(0, c.red  (), c.blue ());
+    case ColorType::RGB_B: return pack(0, c.red  (), c.green());
+    case ColorType::ALPHA: return pack(c.red(), c.green(), c.blue());
+    case ColorType::HSL_H:
+    case ColorType::HSL_S:
+    case ColorType::HSL_L:
+      c.getHslF(&h, &s, &l, &a);
+
+      // achromatic (h = -1) flag
+      // hue strip is pure hues (independent of color)
+      if      (type == ColorType::HSL_H) return 0;
+      else if (type == ColorType::HSL_S) return pack(h < 0, component16(h), component16(l));
+      else                               return pack(h < 0, component16(h), component16(s));
+    default:
+      c.getCmykF(&cc, &m, &y, &k, &a);
+
+      if      (type == ColorType::CMYK_C)
+        return pack(component16(m ), component16(y), component16(k));
+      else if (type == ColorType::CMYK_M)
+        return pack(component16(cc), component16(y), component16(k));
+      else if (type == ColorType::CMYK_Y)
+        return pack(component16(cc), component16(m), component16(k));
+      else
+        return pack(component16(cc), component16(m), component16(y));
+  }
+}
+
+std::atomic<bool> s_linearFill { true };
+
+// get end colors if strip is linear in rgba (RGB and alpha channels)
+bool linearStops(CQColorSelector::ColorType type, const QColor &c, QColor &c1, QColor &c2) {
+  using ColorType = CQColorSelector::ColorType;
+
+  if (! s_linearFill)
+    return false;
+
+  int r = c.red(), g = c.green(), b = c.blue();
+
+  switch (type) {
+    case ColorType::RGB_R: c1 = QColor(0, g, b); c2 = QColor(255, g, b); return true;
+    case ColorType::RGB_G: c1 = QColor(r, 0, b); c2 = QColor(r, 255, b); return true;
+    case ColorType::RGB_B: c1 = QColor(r, g, 0); c2 = QColor(r, g, 255); return true;
+    case ColorType::ALPHA: c1 = QColor(r, g, b, 0); c2 = QColor(r, g, b, 255); return true;
+    default              : return false;
+  }
+}
+
+// fill rect with horizontal linear gradient (end colors at first/last pixel centers)
+void fillLinear(QPainter *p, const QRect &rect, const QColor &c1, const QColor &c2) {
+  QLinearGradient lg(rect.x() + 0.5, 0.0, rect.x() + rect.width() - 0.5, 0.0);
+
+  lg.setColorAt(0.0, c1);
+  lg.setColorAt(1.0, c2);
+
+  p->fillRect(rect, QBrush(lg));
+}
+
+// get indicator x for channel value
+int indicatorX(CQColorSelector::ColorType type, const QColor &c, int pw) {
+  return int(channelValue(c, type)*(pw - 1.0) + 0.5);
+}
+
+// get shared strip for channel from render cache (ix set to indicator x)
+QImage cachedStrip(CQColorSelector::ColorType type, const QColor &c, int pw, double dpr,
+                   int &ix) {
+  ix = indicatorX(type, c, pw);
+
+  uint64_t components = (uint64_t(type) << 56) | stripComponents(type, c);
+
+  CQColorRenderCache::Key key(CQColorRenderCache::Kind::GRADIENT_STRIP, QSize(pw, 1),
+                              dpr, components);
+
+  return CQColorRenderCache::instance()->image(key, [&]() {
+    int ix1;
+
+    return CQColorGradient::renderStrip(type, c, pw, ix1);
+  });
+}
+
+}
+
+//------
+
+CQColorGradient::
+CQColorGradient(CQColorSelector *stroke, ColorType type) :
+ stroke_(stroke), type_(type),
+ tabletInput_(this, [this](const QPointF &p) {
+   setPositionValue(p.x()); return updatePending_; })
+{
+  setObjectName("gradient");
+
+  QFontMetrics fm(font());
+
+  setFixedHeight(fm.height() + 4);
+}
+
+void
+CQColorGradient::
+mousePressEvent(QMouseEvent *e)
+{
+  // other buttons do not pick or start an interaction
+  if (e->button() != Qt::LeftButton || pressed_)
+    return;
+
+  pressed_ = true;
+
+  stroke_->beginInteraction();
+
+  int v = pixelToColor(e->pos().x(), width());
+
+  stroke_->setColorType(type_, v);
+}
+
+void
+CQColorGradient::
+mouseMoveEvent(QMouseEvent *e)
+{
+  if (! pressed_)
+    return;
+
+  int v = pixelToColor(e->pos().x(), width());
+
+  stroke_->setColorType(type_, v);
+}
+
+void
+CQColorGradient::
+mouseReleaseEvent(QMouseEvent *e)
+{
+  if (! pressed_ || e->button() != Qt::LeftButton)
+    return;
+
+  int v = pixelToColor(e->pos().x(), width());
+
+  stroke_->setColorType(type_, v);
+
+  pressed_ = false;
+
+  stroke_->endInteraction();
+}
+
+void
+CQColorGradient::
+tabletEvent(QTabletEvent *e)
+{
+  // accept so no synthesized mouse events, moves are compressed to one per frame
+  e->accept();
+
+  if      (e->type() == QEvent::TabletPress) {
+    if (e->button() != Qt::LeftButton || pressed_)
+      return;
+
+    pressed_ = true;
+
+    stroke_->beginInteraction();
+
+    setPositionValue(e->posF().x());
+  }
+  else if (e->type() == QEvent::TabletMove) {
+    if (pressed_)
+      tabletInput_.post(e->posF());
+  }
+  else if (e->type() == QEvent::TabletRelease) {
+    if (! pressed_ || e->button() != Qt::LeftButton)
+      return;
+
+    tabletInput_.flush();
+
+    setPositionValue(e->posF().x());
+
+    pressed_ = false;
+
+    stroke_->endInteraction();
+  }
+}
+
+void
+CQColorGradient::
+setPositionValue(double x)
+{
+  // sub-pixel position to channel value
+  stroke_->setColorTypeF(type_, clamp(x/std::max(width() - 1, 1), 0.0, 1.0));
+}
+
+bool
+CQColorGradient::
+isLinearFill()
+{
+  return s_linearFill;
+}
+
+void
+CQColorGradient::
+setLinearFill(bool b)
+{
+  s_linearFill = b;
+}
+
+QImage
+CQColorGradient::
+renderStrip(ColorType type, const QColor &qc, int pw, int &ix)
+{
+  // one pixel high strip of column colors (stretched to height)
+  QImage strip(std::max(pw, 1), 1, QImage::Format_ARGB32);
+
+  auto *line = reinterpret_cast<QRgb *>(strip.scanLine(0));
+
+  stripKernel(type)(qc, line, pw, ix);
+
+  return strip;
+}
+
+QImage
+CQColorGradient::
+renderImage(ColorType type, const QColor &c, const QSize &size, CQColorCVD::Type cvd)
+{
+  int pw = size.width ();
+  int ph = size.height();
+
+  QImage image(std::max(pw, 1), std::max(ph, 1), QImage::Format_ARGB32_Premultiplied);
+
+  image.fill(0);
+
+  QPainter p(&image);
+
+  if (type == ColorType::ALPHA)
+    paintCheckerboard(&p, 0, 0, pw, ph, 7);
+
+  // linear rgba rows are filled with gradient brush (no strip sampling)
+  QColor c1, c2;
+
+  if (cvd == CQColorCVD::Type::NONE && linearStops(type, c, c1, c2)) {
+    fillLinear(&p, QRect(0, 0, pw, ph), c1, c2);
+
+    drawIndicators(&p, indicatorX(type, c, pw), ph);
+
+    return image;
+  }
+
+  int ix;
+
+  auto strip = cachedStrip(type, c, pw, 1.0, ix);
+
+  CQColorCVD::simulateImage(strip, cvd);
+
+  p.drawImage(QRect(0, 0, pw, ph), strip);
+
+  drawIndicators(&p, ix, ph);
+
+  return image;
+}
+
+void
+CQColorGradient::
+updateColor()
+{
+  // background only depends on the other channels so a change of this channel's
+  // value (e.g. dragging it) only needs the old and new indicators repainted
+  if (background_.isNull() || backgroundKey() != backgroundKey_) {
+    updatePending_ = true;
+
+    update();
+
+    return;
+  }
+
+  int ix = indicatorX(type_, stroke_->color(), width());
+
+  if (ix == ix_)
+    return;
+
+  updatePending_ = true;
+
+  update(indicatorRect(ix_));
+  update(indicatorRect(ix ));
+}
+
+CQColorGradient::BackgroundKey
+CQColorGradient::
+backgroundKey() const
+{
+  BackgroundKey key;
+
+  key.size       = size();
+  key.dpr        = devicePixelRatioF();
+  key.components = (uint64_t(type_) << 56) | stripComponents(type_, stroke_->color());
+  key.cvd        = int(stroke_->cvdType());
+  key.hasRef     = (stroke_->hasReferenceColor() && type_ != ColorType::ALPHA);
+  key.reference  = (key.hasRef ? stroke_->referenceColor().rgba() : 0);
+  key.linear     = isLinearFill();
+
+  return key;
+}
+
+QRect
+CQColorGradient::
+indicatorRect(int x) const
+{
+  // indicator triangles are +/-4 pixels (plus pen and antialiasing)
+  return QRect(x - 6, 0, 13, height());
+}
+
+void
+CQColorGradient::
+paintEvent(QPaintEvent *e)
+{
+  auto key = backgroundKey();
+
+  if (background_.isNull() || key != backgroundKey_)
+    updateBackground(key);
+
+  //---
+
+  QPainter p(this);
+
+  // only copy exposed part of cached background
+  const auto &r = e->rect();
+
+  double dpr = background_.devicePixelRatioF();
+
+  p.drawImage(r, background_, QRectF(r.x()*dpr, r.y()*dpr, r.width()*dpr, r.height()*dpr));
+
+  ix_ = indicatorX(type_, stroke_->color(), width());
+
+  drawIndicators(&p, ix_, height());
+
+  updatePending_ = false;
+
+  tabletInput_.painted();
+}
+
+void
+CQColorGradient::
+updateBackground(const BackgroundKey &key)
+{
+  backgroundKey_ = key;
+
+  ++numBackgroundUpdates_;
+
+  //---
+
+  auto qc = stroke_->color();
+
+  int pw = width ();
+  int ph = height();
+
+  background_ = QImage(std::max(int(pw*key.dpr), 1), std::max(int(ph*key.dpr), 1),
+                       QImage::Format_ARGB32_Premultiplied);
+
+  background_.setDevicePixelRatio(key.dpr);
+
+  background_.fill(0);
+
+  QPainter p(&background_);
+
+  if (type_ == ColorType::ALPHA)
+    paintCheckerboard(&p, 0, 0, pw, ph, 7);
+
+  //---
+
+  // linear rgba rows are filled with gradient brush (no strip sampling) unless the
+  // sampled colors are needed for simulation or contrast contours
+  QColor c1, c2;
+
+  bool needStrip = (stroke_->cvdType() != CQColorCVD::Type::NONE || key.hasRef);
+
+  if (! needStrip && linearStops(type_, qc, c1, c2)) {
+    lum_.clear();
+
+    fillLinear(&p, QRect(0, 0, pw, ph), c1, c2);
+
+    return;
+  }
+
+  //---
+
+  int ix;
+
+  auto strip = cachedStrip(type_, qc, pw, key.dpr, ix);
+
+  auto *line = reinterpret_cast<const QRgb *>(strip.constScanLine(0));
+
+  //---
+
+  // luminance of actual (not simulated) colors for contrast
+  if (key.hasRef) {
+    lum_.resize(pw);
+
+    for (int x = 0; x < pw; ++x)
+      lum_[x] = CQColorContrast::luminance(line[x]);
+  }
+  else
+    lum_.clear();
+
+  CQColorCVD::simulateImage(strip, stroke_->cvdType());
+
+  p.drawImage(QRect(0, 0, pw, ph), strip);
+
+  drawContours(&p, strip);
+}
+
+void
+CQColorGradient::
+drawContours(QPainter *p, const QImage &strip)
+{
+  if (lum_.empty())
+    return;
+
+  // vertical line where contrast ratio crosses a threshold
+  double lref = CQColorContrast::luminance(stroke_->referenceColor());
+
+  int ph = height();
+
+  int level1 = CQColorContrast::level(CQColorContrast::contrastRatio(lum_[0], lref));
+
+  for (int x = 1; x < int(lum_.size()); ++x) {
+    int level2 = CQColorContrast::level(CQColorContrast::contrastRatio(lum_[x], lref));
+
+    if (level2 != level1) {
+      p->setPen(QPen(toBW(QColor(strip.pixel(x, 0))), 1, Qt::DashLine));
+
+      p->drawLine(x, 0, x, ph - 1);
+    }
+
+    level1 = level2;
+  }
+}
+
+//------
+
+CQColorChannelPanel::
+CQColorChannelPanel(CQColorSelector *stroke, const Channels &channels) :
+ stroke_(stroke), channels_(channels)
+{
+  setObjectName("panel");
+
+  setFocusPolicy(Qt::StrongFocus);
+
+  setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
+
+  QFontMetrics fm(font());
+
+  rowHeight_  = fm.height() + 4;
+  labelWidth_ = fm.horizontalAdvance("W");
+  valueWidth_ = fm.horizontalAdvance("0000") + 8;
+
+  calcLayout();
+}
+
+QSize
+CQColorChannelPanel::
+sizeHint() const
+{
+  int n = int(channels_.size());
+
+  return QSize(labelWidth_ + valueWidth_ + 200 + 8, n*(rowHeight_ + 2) + 2);
+}
+
+QSize
+CQColorChannelPanel::
+minimumSizeHint() const
+{
+  int n = int(channels_.size());
+
+  return QSize(labelWidth_ + valueWidth_ + 32 + 8, n*(rowHeight_ + 2) + 2);
+}
+
+void
+CQColorChannelPanel::
+resizeEvent(QResizeEvent *)
+{
+  calcLayout();
+}
+
+void
+CQColorChannelPanel::
+calcLayout()
+{
+  // row: margin, label, spacing, gradient, spacing, value, margin
+  int n = int(channels_.size());
+
+  rows_.resize(n);
+
+  int gw = std::max(width() - labelWidth_ - valueWidth_ - 8, 1);
+
+  int y = 2;
+
+  for (int i = 0; i < n; ++i) {
+    auto &row = rows_[i];
+
+    int x = 2;
+
+    row.labelRect    = QRect(x, y, labelWidth_, rowHeight_); x += labelWidth_ + 2;
+    row.gradientRect = QRect(x, y, gw         , rowHeight_); x += gw + 2;
+    row.valueRect    = QRect(x, y, valueWidth_, rowHeight_);
+
+    y += rowHeight_ + 2;
+  }
+}
+
+bool
+CQColorChannelPanel::
+hitTest(const QPoint &p, int &row, Part &part) const
+{
+  row  = -1;
+  part = Part::NONE;
+
+  for (int i = 0; i < int(rows_.size()); ++i) {
+    const auto &r = rows_[i];
+
+    if (p.y() < r.labelRect.top() || p.y() > r.labelRect.bottom())
+      continue;
+
+    row = i;
+
+    if      (r.labelRect   .contains(p)) part = Part::LABEL;
+    else if (r.gradientRect.contains(p)) part = Part::GRADIENT;
+    else if (r.valueRect   .contains(p)) part = Part::VALUE;
+
+    return (part != Part::NONE);
+  }
+
+  return false;
+}
+
+int
+CQColorChannelPanel::
+value(int row) const
+{
+  // same 0-255 scale as CQColorSpin
+  return int(channelValue(stroke_->color(), channels_[row].type)*255.0f + 0.5f);
+}
+
+void
+CQColorChannelPanel::
+setValue(int row, int v)
+{
+  stroke_->setColorType(channels_[row].type, int(clamp(v, 0, 255)));
+}
+
+void
+CQColorChannelPanel::
+setGradientValue(int row, int x)
+{
+  const auto &r = rows_[row].gradientRect;
+
+  int x1 = int(clamp(x - r.x(), 0, r.width() - 1));
+
+  setValue(row, pixelToColor(x1, r.width()));
+}
+
+void
+CQColorChannelPanel::
+paintEvent(QPaintEvent *)
+{
+  QPainter p(this);
+
+  auto qc  = stroke_->color();
+  auto cvd = stroke_->cvdType();
+
+  for (int i = 0; i < int(rows_.size()); ++i) {
+    const auto &r = rows_[i];
+
+    p.setPen(palette().color(QPalette::WindowText));
+
+    p.drawText(r.labelRect, Qt::AlignCenter, channels_[i].label);
+
+    //---
+
+    p.drawImage(r.gradientRect.topLeft(),
+                CQColorGradient::renderImage(channels_[i].type, qc, r.gradientRect.size(), cvd));
+
+    //---
+
+    // value field (inline edit text when editing)
+    bool editing = (i == editRow_);
+
+    p.fillRect(r.valueRect, palette().color(QPalette::Base));
+
+    p.setPen(palette().color(editing && hasFocus() ? QPalette::Highlight : QPalette::Mid));
+
+    p.drawRect(r.valueRect.adjusted(0, 0, -1, -1));
+
+    auto text = (editing ? editText_ : QString::number(value(i)));
+
+    QRect tr = r.valueRect.adjusted(3, 0, -3, 0);
+
+    if (editing && editFresh_) {
+      QRect br = p.fontMetrics().boundingRect(tr, Qt::AlignRight | Qt::AlignVCenter, text);
+
+      p.fillRect(br, palette().color(QPalette::Highlight));
+
+      p.setPen(palette().color(QPalette::HighlightedText));
+    }
+    else
+      p.setPen(palette().color(QPalette::Text));
+
+    p.drawText(tr, Qt::AlignRight | Qt::AlignVCenter, text);
+  }
+}
+
+void
+CQColorChannelPanel::
+mousePressEvent(QMouseEvent *e)
+{
+  // other buttons do not drag or edit, press during drag is ignored
+  if (e->button() != Qt::LeftButton || dragRow_ >= 0)
+    return;
+
+  int  row;
+  Part part;
+
+  if (! hitTest(e->pos(), row, part))
+    return;
+
+  if      (part == Part::GRADIENT) {
+    commitEdit();
+
+    dragRow_ = row;
+
+    stroke_->beginInteraction();
+
+    setGradientValue(row, e->pos().x());
+  }
+  else if (part == Part::VALUE) {
+    if (row != editRow_)
+      commitEdit();
+
+    startEdit(row);
+  }
+}
+
+void
+CQColorChannelPanel::
+mouseMoveEvent(QMouseEvent *e)
+{
+  if (dragRow_ >= 0)
+    setGradientValue(dragRow_, e->pos().x());
+}
+
+void
+CQColorChannelPanel::
+mouseReleaseEvent(QMouseEvent *e)
+{
+  if (dragRow_ < 0 || e->button() != Qt::LeftButton)
+    return;
+
+  setGradientValue(dragRow_, e->pos().x());
+
+  dragRow_ = -1;
+
+  stroke_->endInteraction();
+}
+
+void
+CQColorChannelPanel::
+wheelEvent(QWheelEvent *e)
+{
+  int  row;
+  Part part;
+
+  if (! hitTest(e->position().toPoint(), row, part) || part == Part::LABEL)
+    return;
+
+  int d = (e->angleDelta().y() > 0 ? 1 : -1);
+
+  if (e->modifiers() & Qt::ShiftModifier)
+    d *= 10;
+
+  if (row == editRow_)
+    cancelEdit();
+
+  setValue(row, value(row) + d);
+}
+
+void
+CQColorChannelPanel::
+keyPressEvent(QKeyEvent *e)
+{
+  if (editRow_ < 0) {
+    QWidget::keyPressEvent(e);
+    return;
+  }
+
+  int d = (e->modifiers() & Qt::ShiftModifier ? 10 : 1);
+
+  switch (e->key()) {
+    case Qt::Key_Return:
+    case Qt::Key_Enter:
+      commitEdit();
+      break;
+    case Qt::Key_Escape:
+      cancelEdit();
+      break;
+    case Qt::Key_Up:
+    case Qt::Key_Down: {
+      int row = editRow_;
+
+      setValue(row, value(row) + (e->key() == Qt::Key_Up ? d : -d));
+
+      startEdit(row);
+
+      break;
+    }
+    case Qt::Key_Backspace:
+      if (editFresh_)
+        editText_.clear();
+      else
+        editText_.chop(1);
+
+      editFresh_ = false;
+
+      update();
+
+      break;
+    default: {
+      auto text = e->text();
+
+      if (text.length() == 1 && text[0].isDigit()) {
+        if (editFresh_)
+          editText_.clear();
+
+        if (editText_.length() < 3)
+          editText_ += text;
+
+        editFresh_ = false;
+
+        update();
+      }
+      else
+        QWidget::keyPressEvent(e);
+
+      break;
+    }
+  }
+}
+
+void
+CQColorChannelPanel::
+focusOutEvent(QFocusEvent *)
+{
+  commitEdit();
+}
+
+void
+CQColorChannelPanel::
+startEdit(int row)
+{
+  editRow_   = row;
+  editText_  = QString::number(value(row));
+  editFresh_ = true;
+
+  setFocus();
+
+  update();
+}
+
+void
+CQColorChannelPanel::
+commitEdit()
+{
+  if (editRow_ < 0)
+    return;
+
+  int row = editRow_;
+
+  bool ok;
+
+  int v = editText_.toInt(&ok);
+
+  editRow_ = -1;
+
+  if (ok && v != value(row))
+    setValue(row, v);
+
+  update();
+}
+
+void
+CQColorChannelPanel::
+cancelEdit()
+{
+  editRow_ = -1;
+
+  update();
+}
+
+//------
+
+CQColorSelectorWheel::
+CQColorSelectorWheel(CQColorSelector *stroke) :
+ stroke_(stroke), circle_(false), triangle_(false), pressX_(0), pressY_(0),
+ tabletInput_(this, [this](const QPointF &p) { moveAt(p); return updatePending_; })
+{
+  setObjectName("wheel");
+
+  calcGeometry();
+}
+
+void
+CQColorSelectorWheel::
+mousePressEvent(QMouseEvent *e)
+{
+  // other buttons (right for context menu) do not pick or start an interaction
+  if (e->button() != Qt::LeftButton)
+    return;
+
+  pressAt(e->pos());
+}
+
+void
+CQColorSelectorWheel::
+mouseMoveEvent(QMouseEvent *e)
+{
+  if (! pressed_)
+    return;
+
+  moveAt(e->pos());
+}
+
+void
+CQColorSelectorWheel::
+mouseReleaseEvent(QMouseEvent *e)
+{
+  if (! pressed_ || e->button() != Qt::LeftButton)
+    return;
+
+  releaseAt(e->pos());
+}
+
+void
+CQColorSelectorWheel::
+tabletEvent(QTabletEvent *e)
+{
+  // accept so no synthesized mouse events, moves are compressed to one per frame
+  e->accept();
+
+  if      (e->type() == QEvent::TabletPress) {
+    if (e->button() == Qt::LeftButton)
+      pressAt(e->posF());
+  }
+  else if (e->type() == QEvent::TabletMove) {
+    if (circle_ || triangle_ || harmony_ >= 0)
+      tabletInput_.post(e->posF());
+  }
+  else if (e->type() == QEvent::TabletRelease) {
+    if (! pressed_ || e->button() != Qt::LeftButton)
+      return;
+
+    tabletInput_.flush();
+
+    releaseAt(e->posF());
+  }
+}
+
+void
+CQColorSelectorWheel::
+pressAt(const QPointF &p)
+{
+  circle_   = false;
+  triangle_ = false;
+  harmony_  = -1;
+  pressX_   = p.x();
+  pressY_   = p.y();
+
+  if (! pressed_) {
+    pressed_ = true;
+
+    stroke_->beginInteraction();
+  }
+
+  harmony_ = harmonyMarkerAt(pressX_, pressY_);
+
+  if (harmony_ >= 0) {
+    updateHarmony(pressX_, pressY_);
+    return;
+  }
+
+  if (updateCircle(pressX_, pressY_, true)) {
+    circle_ = true;
+    return;
+  }
+
+  if (updateTriangle(pressX_, pressY_, true)) {
+    triangle_ = true;
+    return;
+  }
+}
+
+void
+CQColorSelectorWheel::
+moveAt(const QPointF &p)
+{
+  pressX_ = p.x();
+  pressY_ = p.y();
+
+  if (harmony_ >= 0)
+    updateHarmony(pressX_, pressY_);
+
+  if (circle_)
+    updateCircle(pressX_, pressY_, false);
+
+  if (triangle_)
+    updateTriangle(pressX_, pressY_, false);
+}
+
+void
+CQColorSelectorWheel::
+releaseAt(const QPointF &p)
+{
+  moveAt(p);
+
+  circle_   = false;
+  triangle_ = false;
+  harmony_  = -1;
+
+  if (pressed_) {
+    pressed_ = false;
+
+    stroke_->endInteraction();
+  }
+}
+
+void
+CQColorSelectorWheel::
+contextMenuEvent(QContextMenuEvent *e)
+{
+  using HarmonyMode = CQColorSelector::HarmonyMode;
+
+  // menu takes any pending release so end drag now
+  if (pressed_)
+    releaseAt(QPointF(pressX_, pressY_));
+
+  QMenu menu;
+
+  auto *group = new QActionGroup(&menu);
+
+  auto addAction = [&](const QString &name, HarmonyMode mode) {
+    auto *action = menu.addAction(name);
+
+    action->setCheckable(true);
+    action->setChecked(stroke_->harmonyMode() == mode);
+
+    group->addAction(action);
+
+    connect(action, &QAction::triggered, [this, mode]() { stroke_->setHarmonyMode(mode); });
+  };
+
+  addAction("No Harmony"         , HarmonyMode::NONE);
+  addAction("Complementary"      , HarmonyMode::COMPLEMENTARY);
+  addAction("Triad"              , HarmonyMode::TRIAD);
+  addAction("Analogous"          , HarmonyMode::ANALOGOUS);
+  addAction("Split Complementary", HarmonyMode::SPLIT_COMPLEMENTARY);
+  addAction("Tetrad"             , HarmonyMode::TETRAD);
+
+  menu.exec(e->globalPos());
+}
+
+bool
+CQColorSelectorWheel::
+updateCircle(double x, double y, bool checkInside)
+{
+  double y1 = geom_.ps - 1 - y;
+
+  double dx = x - geom_.xc;
+  double dy = y1 - geom_.yc;
+
+  double r = sqrt(dx*dx + dy*dy);
+
+  if (checkInside && (r < geom_.ri || r > geom_.ro)) {
     // TODO: move point inside if not check insde
     return false;
   }
 
-  double a1 = atan2(dy, dx);
+  double a1 = atan2(dy, dx);
+
+  if (a1 < 0) a1 = 2*M_PI + a1;
+
+  double hue = 0.5*a1/M_PI;
+
+  //---
+
+  auto qc = stroke_->color();
+
+  double h, s, l, a;
+
+  qc.getHslF(&h, &s, &l, &a);
+
+  qc.setHslF(hue, s, l, a);
+
+  stroke_->setColorChannels(qc, { CQColorSelector::ColorType::HSL_H });
+
+  return true;
+}
+
+bool
+CQColorSelectorWheel::
+updateTriangle(double x, double y, bool /*checkInside*/)
+{
+  double b1, b2, b3;
+
+  if (! geom_.toBarycentric(x, y, b1, b2, b3))
+    return false;
+
+  b1 = clamp(b1, 0, 1);
+  b2 = clamp(b2, 0, 1);
+  b3 = clamp(b3, 0, 1);
+
+  //---
+
+  auto qc = stroke_->color();
+
+  double h, s, l, a;
+
+  qc.getHslF(&h, &s, &l, &a);
+
+  s = clamp(b2         , 0.0, 1.0);
+  l = clamp(b2*0.5 + b1, 0.0, 1.0);
+
+  qc.setHslF(h, s, l, a);
+
+  stroke_->setColorChannels(qc, { CQColorSelector::ColorType::HSL_S,
+                                  CQColorSelector::ColorType::HSL_L });
+
+  return true;
+}
+
+void
+CQColorSelectorWheel::
+resizeEvent(QResizeEvent *)
+{
+  calcGeometry();
+}
+
+void
+CQColorSelectorWheel::
+calcGeometry()
+{
+  geom_.init(std::min(width(), height()));
+
+  geom_.calcTriangle(std::max(stroke_->color().hslHueF(), 0.0));
+}
+
+double
+CQColorSelectorWheel::
+pointToHue(double x, double y) const
+{
+  return geom_.pointToHue(x, y);
+}
+
+void
+CQColorSelectorWheel::
+harmonyMarkerPoint(double hue, double &x, double &y)
+{
+  geom_.angleToPoint((geom_.ri + geom_.ro)/2.0, hue*M_PI*2, x, y);
+}
+
+int
+CQColorSelectorWheel::
+harmonyMarkerAt(double x, double y)
+{
+  auto hues = stroke_->harmonyHues();
+
+  // first hue is base color (use circle)
+  for (int i = 1; i < int(hues.size()); ++i) {
+    double xm, ym;
+
+    harmonyMarkerPoint(hues[i], xm, ym);
+
+    if (hypot(x - xm, y - ym) <= markerRadius() + 2)
+      return i;
+  }
+
+  return -1;
+}
+
+void
+CQColorSelectorWheel::
+updateHarmony(double x, double y)
+{
+  stroke_->dragHarmony(harmony_, pointToHue(x, y));
+}
+
+double
+CQColorSelectorWheel::
+markerRadius() const
+{
+  return std::max((geom_.ro - geom_.ri)/2.0 - 2.0, 3.0);
+}
+
+void
+CQColorSelectorWheel::
+updateRingImage()
+{
+  int  ps  = int(geom_.ps);
+  auto cvd = stroke_->cvdType();
+
+  CQColorRenderCache::Key key(CQColorRenderCache::Kind::WHEEL_RING, QSize(ps, ps),
+                              devicePixelRatioF(), uint64_t(cvd));
+
+  ringImage_ = CQColorRenderCache::instance()->image(key, [&]() {
+    return renderRing(ps, cvd);
+  });
+}
+
+void
+CQColorSelectorWheel::
+updateTriangleImage(double h)
+{
+  auto cvd = stroke_->cvdType();
+
+  if (stroke_->hasReferenceColor()) {
+    // luminance needed for contrast contours (not cached)
+    triangleImage_ = renderTriangle(geom_, h, cvd, trianglePos_, &triangleLum_);
+  }
+  else {
+    int ps = int(geom_.ps);
+
+    uint64_t components = (uint64_t(cvd) << 16) | uint64_t(qRound(h*65535.0));
+
+    CQColorRenderCache::Key key(CQColorRenderCache::Kind::WHEEL_TRIANGLE, QSize(ps, ps),
+                                devicePixelRatioF(), components);
+
+    triangleImage_ = CQColorRenderCache::instance()->image(key, [&]() {
+      QPoint pos;
+
+      return renderTriangle(geom_, h, cvd, pos);
+    });
+
+    trianglePos_ = geom_.triangleRect().topLeft();
+
+    triangleLum_.clear();
+  }
+
+  triangleHue_  = h;
+  triangleSize_ = int(geom_.ps);
+
+  ++triangleUpdates_;
+}
+
+void
+CQColorSelectorWheel::
+updateContourImage()
+{
+  // contour pixels where contrast level differs from right or lower pixel
+  int tw = triangleImage_.width ();
+  int th = triangleImage_.height();
+
+  contourImage_ = QImage(tw, th, QImage::Format_ARGB32_Premultiplied);
+
+  contourImage_.fill(0);
+
+  double lref = CQColorContrast::luminance(stroke_->referenceColor());
+
+  std::vector<int> levels(size_t(tw)*th, -1);
+
+  for (size_t i = 0; i < levels.size(); ++i) {
+    if (triangleLum_[i] >= 0.0f)
+      levels[i] = CQColorContrast::level(CQColorContrast::contrastRatio(triangleLum_[i], lref));
+  }
+
+  for (int y = 0; y < th; ++y) {
+    auto *line = reinterpret_cast<QRgb *>(contourImage_.scanLine(y));
+
+    for (int x = 0; x < tw; ++x) {
+      int l = levels[size_t(y)*tw + x];
+
+      if (l < 0)
+        continue;
+
+      int lr = (x < tw - 1 ? levels[size_t(y    )*tw + x + 1] : -1);
+      int lb = (y < th - 1 ? levels[size_t(y + 1)*tw + x    ] : -1);
+
+      if ((lr >= 0 && lr != l) || (lb >= 0 && lb != l))
+        line[x] = (triangleLum_[size_t(y)*tw + x] > 0.18f ? qRgb(0, 0, 0) : qRgb(255, 255, 255));
+    }
+  }
+
+  contourRef_     = stroke_->referenceColor().rgba();
+  contourUpdates_ = triangleUpdates_;
+}
+
+void
+CQColorSelectorWheel::
+updateColor()
+{
+  updatePending_ = true;
+
+  update();
+}
+
+void
+CQColorSelectorWheel::
+clearCache()
+{
+  ringImage_     = QImage();
+  triangleImage_ = QImage();
+
+  update();
+}
+
+void
+CQColorSelectorWheel::
+paintEvent(QPaintEvent *)
+{
+  QPainter p(this);
+
+  if (int(geom_.ps) != std::min(width(), height()))
+    calcGeometry();
+
+  //---
+
+  auto qc = stroke_->color();
+
+  double h, s, l, a;
+
+  qc.getHslF(&h, &s, &l, &a);
+
+  //---
+
+  // ring layer (only changes with size)
+  if (ringImage_.isNull() || ringImage_.width() != int(geom_.ps))
+    updateRingImage();
+
+  p.drawImage(0, 0, ringImage_);
+
+  //---
+
+  // triangle layer (changes with size and hue)
+  geom_.calcTriangle(h);
+
+  if (triangleImage_.isNull() || triangleSize_ != int(geom_.ps) || triangleHue_ != h ||
+      (stroke_->hasReferenceColor() && triangleLum_.empty()))
+    updateTriangleImage(h);
+
+  p.drawImage(trianglePos_, triangleImage_);
+
+  //---
+
+  // contrast contours (changes with triangle and reference color)
+  if (stroke_->hasReferenceColor()) {
+    if (contourUpdates_ != triangleUpdates_ ||
+        contourRef_ != stroke_->referenceColor().rgba())
+      updateContourImage();
+
+    p.drawImage(trianglePos_, contourImage_);
+  }
+
+  //---
 
-  if (a1 < 0) a1 = 2*M_PI + a1;
+  drawOverlay(&p);
 
-  double hue = 0.5*a1/M_PI;
+  updatePending_ = false;
+
+  tabletInput_.painted();
+}
+
+void
+CQColorSelectorWheel::
+drawOverlay(QPainter *p)
+{
+  drawColorMarkers(p, geom_, stroke_->color(), stroke_->cvdType());
 
   //---
 
-  auto qc = stroke_->color();
+  // harmony markers (first is base hue)
+  auto hues = stroke_->harmonyHues();
 
-  double h, s, l, a;
+  if (hues.size() > 1) {
+    p->setRenderHint(QPainter::Antialiasing);
 
-  qc.getHslF(&h, &s, &l, &a);
+    double mr = markerRadius();
 
-  qc.setHslF(hue, s, l, a);
+    for (int i = 1; i < int(hues.size()); ++i) {
+      double xm, ym;
 
-  stroke_->setColor(qc);
+      harmonyMarkerPoint(hues[i], xm, ym);
 
-  return true;
+      auto hc = stroke_->displayColor(QColor::fromHslF(hues[i], 1, 0.5));
+
+      p->setPen  (toBW(hc));
+      p->setBrush(hc);
+
+      p->drawEllipse(QPointF(xm, ym), mr, mr);
+    }
+
+    p->setRenderHint(QPainter::Antialiasing, false);
+  }
 }
 
-bool
+QImage
 CQColorSelectorWheel::
-updateTriangle(int x, int y, bool /*checkInside*/)
+renderRing(int size, CQColorCVD::Type cvd)
 {
-  double b1, b2, b3;
+  Geometry geom;
 
-  if (! toBarycentric(x, y, b1, b2, b3))
-    return false;
+  geom.init(size);
 
-  b1 = clamp(b1, 0, 1);
-  b2 = clamp(b2, 0, 1);
-  b3 = clamp(b3, 0, 1);
+  int ps = std::max(size, 1);
 
-  //---
+  QImage image(ps, ps, QImage::Format_ARGB32_Premultiplied);
 
-  auto qc = stroke_->color();
+  image.fill(0);
+
+  for (int y = 0; y < size; ++y) {
+    auto *line = reinterpret_cast<QRgb *>(image.scanLine(y));
+
+    double y1 = geom.ps - 1 - y;
+
+    double dy = y1 - geom.yc;
+
+    for (int x = 0; x < size; ++x) {
+      double dx = x - geom.xc;
+
+      double r = sqrt(dx*dx + dy*dy);
+
+      if (r < geom.ri || r > geom.ro)
+        continue;
+
+      double a = atan2(dy, dx);
+
+      if (a < 0) a = 2*M_PI + a;
+
+      double hue = 0.5*a/M_PI;
+
+      line[x] = CQColorHSL::toRgb(hue, 1, 0.5);
+    }
+  }
+
+  CQColorCVD::simulateImage(image, cvd);
+
+  return image;
+}
+
+QImage
+CQColorSelectorWheel::
+renderTriangle(const Geometry &geom, double h, CQColorCVD::Type cvd,
+               QPoint &pos, std::vector<float> *lums)
+{
+  QRect rect = geom.triangleRect();
+
+  int pxmin = rect.left  ();
+  int pymin = rect.top   ();
+  int pxmax = rect.right ();
+  int pymax = rect.bottom();
+
+  pos = rect.topLeft();
 
+  QImage image(rect.size(), QImage::Format_ARGB32_Premultiplied);
+
+  image.fill(0);
+
+  int tw = image.width();
+
+  if (lums)
+    lums->assign(size_t(tw)*image.height(), -1.0f);
+
+  for (int y = pymin; y <= pymax; ++y) {
+    auto *line = reinterpret_cast<QRgb *>(image.scanLine(y - pymin));
+
+    float *lum = (lums ? &(*lums)[size_t(y - pymin)*tw] : nullptr);
+
+    for (int x = pxmin; x <= pxmax; ++x) {
+      double b1, b2, b3;
+
+      if (! geom.toBarycentric(x, y, b1, b2, b3))
+        continue;
+
+      double s1 = clamp(b2         , 0.0, 1.0);
+      double l1 = clamp(b2*0.5 + b1, 0.0, 1.0);
+
+      line[x - pxmin] = CQColorHSL::toRgb(h, s1, l1);
+
+      if (lum)
+        lum[x - pxmin] = float(CQColorContrast::luminance(line[x - pxmin]));
+    }
+  }
+
+  CQColorCVD::simulateImage(image, cvd);
+
+  return image;
+}
+
+QImage
+CQColorSelectorWheel::
+renderImage(const QColor &c, int size, CQColorCVD::Type cvd)
+{
+  double h = std::max(c.hslHueF(), 0.0);
+
+  Geometry geom;
+
+  geom.init(size);
+  geom.calcTriangle(h);
+
+  auto image = renderRing(size, cvd);
+
+  QPoint pos;
+
+  auto triangleImage = renderTriangle(geom, h, cvd, pos);
+
+  QPainter p(&image);
+
+  p.drawImage(pos, triangleImage);
+
+  drawColorMarkers(&p, geom, c, cvd);
+
+  return image;
+}
+
+void
+CQColorSelectorWheel::
+drawColorMarkers(QPainter *p, const Geometry &geom, const QColor &qc, CQColorCVD::Type cvd)
+{
   double h, s, l, a;
 
   qc.getHslF(&h, &s, &l, &a);
 
-  s = clamp(b2         , 0.0, 1.0);
-  l = clamp(b2*0.5 + b1, 0.0, 1.0);
+  //---
 
-  qc.setHslF(h, s, l, a);
+  // hue line
+  double la = h*M_PI*2;
+
+  double x1, y1, x2, y2;
+
+  geom.angleToPoint(geom.ri, la, x1, y1);
+  geom.angleToPoint(geom.ro, la, x2, y2);
+
+  QColor lc;
+
+  lc.setHslF(h, 1, 0.5);
+
+  p->setPen(toBW(CQColorCVD::simulate(lc, cvd)));
+
+  p->drawLine(int(x1), int(y1), int(x2), int(y2));
+
+  //---
+
+  // current color marker in triangle
+  //   b2 is weight of p1 (s), b1 is weight of p3 and b3 is weight of p2
+  double b2 = clamp(s         , 0.0, 1.0);
+  double b1 = clamp(l - s*0.5 , 0.0, 1.0);
+  double b3 = clamp(1 - b1 - b2, 0.0, 1.0);
+
+  double bs = b1 + b2 + b3;
+
+  if (bs > 0.0) { b1 /= bs; b2 /= bs; b3 /= bs; }
+
+  int mx = int(b2*geom.xt1 + b3*geom.xt2 + b1*geom.xt3 + 0.5);
+  int my = int(b2*geom.yt1 + b3*geom.yt2 + b1*geom.yt3 + 0.5);
+
+  p->setPen(toBW(qc));
+  p->setBrush(Qt::NoBrush);
+
+  p->drawEllipse(QRect(mx - 3, my - 3, 6, 6));
+}
+
+//------
+
+void
+CQColorSelectorWheel::Geometry::
+init(int size)
+{
+  ps = size;
+
+  // wheel at center (xc, yc), inner radius (ri), out radius (ro)
+  ro = ps/2.0;
+  ri = ro*0.75;
+
+  xc = ro;
+  yc = ro;
+}
+
+void
+CQColorSelectorWheel::Geometry::
+calcTriangle(double h)
+{
+  // calc triangle corners
+  //
+  // p1 (xt1, yt1) is s=1, v=0.5
+  // p2 (xt2, yt2) is s=0, v=0
+  // p3 (xt3, yt3) is s=0, v=1
+
+  double la = h*M_PI*2;
+
+  angleToPoint(ri, la           , xt1, yt1);
+  angleToPoint(ri, la + 2*M_PI/3, xt2, yt2);
+  angleToPoint(ri, la + 4*M_PI/3, xt3, yt3);
+}
+
+QRect
+CQColorSelectorWheel::Geometry::
+triangleRect() const
+{
+  // pixel bounds of triangle
+  int pxmin = int(std::min(std::min(xt1, xt2), xt3));
+  int pymin = int(std::min(std::min(yt1, yt2), yt3));
+  int pxmax = int(std::max(std::max(xt1, xt2), xt3) + 0.9999);
+  int pymax = int(std::max(std::max(yt1, yt2), yt3) + 0.9999);
+
+  return QRect(QPoint(pxmin, pymin), QPoint(pxmax, pymax));
+}
+
+double
+CQColorSelectorWheel::Geometry::
+pointToHue(double x, double y) const
+{
+  double y1 = ps - 1 - y;
+
+  double a1 = atan2(y1 - yc, x - xc);
+
+  if (a1 < 0) a1 = 2*M_PI + a1;
+
+  return 0.5*a1/M_PI;
+}
+
+double
+CQColorSelectorWheel::Geometry::
+pointLineDistance(double x, double y, double xl1, double yl1, double xl2, double yl2)
+{
+  //double plx = x - xl1;
+  //double ply = y - yl1;
+
+  double dlx = xl2 - xl1;
+  double dly = yl2 - yl1;
+
+  double l = hypot(dlx, dly);
+
+  double dot = xl2*yl1 - yl2*xl1;
+
+  double d = fabs(dly*x - dlx*y + dot)/l;
+
+  return d;
+}
+
+bool
+CQColorSelectorWheel::Geometry::
+toBarycentric(double x, double y, double &b1, double &b2, double &b3) const
+{
+  double area21 = triangleArea2(xt1, yt1, xt2, yt2, x, y);
+  double area22 = triangleArea2(xt2, yt2, xt3, yt3, x, y);
+  double area23 = triangleArea2(xt3, yt3, xt1, yt1, x, y);
+
+  bool s1 = (area21 < 0.0);
+  bool s2 = (area22 < 0.0);
+  bool s3 = (area23 < 0.0);
+
+  bool inside = ((s1 == s2) && (s2 == s3));
+
+  double area1 = 0.5*fabs(area21);
+  double area2 = 0.5*fabs(area22);
+  double area3 = 0.5*fabs(area23);
+
+  double is = 1.0/(area1 + area2 + area3);
+
+  b1 = area1*is;
+  b2 = area2*is;
+  b3 = area3*is;
+
+  return inside;
+}
+
+double
+CQColorSelectorWheel::Geometry::
+triangleArea2(double x1, double y1, double x2, double y2, double x3, double y3)
+{
+  return (x2 - x1)*(y3 - y1) - (x3 - x1)*(y2 - y1);
+}
+
+void
+CQColorSelectorWheel::Geometry::
+angleToPoint(double r, double a, double &x, double &y) const
+{
+  x = xc + r*cos(a);
+  y = yc + r*sin(a);
+
+  y = ps - 1 - y;
+}
+
+//------
+
+CQColorSpin::
+CQColorSpin(CQColorSelector *stroke, ColorType type) :
+ QSpinBox(), stroke_(stroke), type_(type)
+{
+  setObjectName("spin");
+
+  setSizePolicy(QSizePolicy::Fixed, QSizePolicy::Fixed);
+
+  setRange(0, 255);
+
+  // edits within burst interval (or until editing finished) are one interaction
+  burstTimer_ = new QTimer(this);
+
+  burstTimer_->setSingleShot(true);
+  burstTimer_->setInterval(750);
+
+  connect(this, SIGNAL(valueChanged(int)), this, SLOT(setColorSlot(int)));
+
+  connect(burstTimer_, SIGNAL(timeout()), this, SLOT(burstEndSlot()));
+  connect(this, SIGNAL(editingFinished()), this, SLOT(burstEndSlot()));
+}
+
+void
+CQColorSpin::
+setColorSlot(int v)
+{
+  // ignore value set from selector color
+  if (stroke_->isUpdating())
+    return;
+
+  if (! burst_) {
+    burst_ = true;
+
+    stroke_->beginInteraction();
+  }
+
+  burstTimer_->start();
+
+  stroke_->setColorType(type_, v);
+}
+
+void
+CQColorSpin::
+burstEndSlot()
+{
+  if (! burst_)
+    return;
+
+  burst_ = false;
+
+  burstTimer_->stop();
+
+  stroke_->endInteraction();
+}
+
+//------
+
+CQColorSwatches::
+CQColorSwatches(CQColorSelector *stroke) :
+ stroke_(stroke)
+{
+  setObjectName("swatches");
+
+  setFixedHeight(swatchSize() + 4);
+}
+
+void
+CQColorSwatches::
+setColors(const Colors &colors)
+{
+  colors_ = colors;
+
+  updateGeometry();
+
+  update();
+}
 
-  stroke_->setColor(qc);
+int
+CQColorSwatches::
+swatchSize() const
+{
+  QFontMetrics fm(font());
 
-  return true;
+  return fm.height();
 }
 
 void
-CQColorSelectorWheel::
+CQColorSwatches::
 paintEvent(QPaintEvent *)
 {
   QPainter p(this);
 
-  int pw = width ();
-  int ph = height();
+  int s = swatchSize();
 
-  ps_ = std::min(pw, ph);
+  int x = 2;
 
-  //---
+  for (const auto &c : colors_) {
+    QRect rect(x, 2, s, s);
 
-  auto qc = stroke_->color();
+    paintCheckerboard(&p, rect.x(), rect.y(), s, s, s/2);
 
-  double h, s, l, a;
+    p.fillRect(rect, QBrush(stroke_->displayColor(c)));
 
-  qc.getHslF(&h, &s, &l, &a);
+    if (c.rgba() == stroke_->color().rgba()) {
+      p.setPen(toBW(c));
 
-  //---
+      p.drawRect(rect.adjusted(0, 0, -1, -1));
+    }
 
-  // draw wheel at center (xc_, yc_), inner radius (ri), out radius (ro)
-  ro_ = ps_/2.0;
-  ri_ = ro_*0.75;
+    x += s + 2;
+  }
+}
 
-  xc_ = ro_;
-  yc_ = ro_;
+void
+CQColorSwatches::
+mousePressEvent(QMouseEvent *e)
+{
+  int s = swatchSize();
 
-  for (int y = 0; y < ps_; ++y) {
-    double y1 = ps_ - 1 - y;
+  int i = (e->pos().x() - 2)/(s + 2);
 
-    double dy = y1 - yc_;
+  if (i < 0 || i >= int(colors_.size()))
+    return;
 
-    for (int x = 0; x < ps_; ++x) {
-      double dx = x - xc_;
+  emit colorPressed(colors_[i]);
+}
 
-      double r = sqrt(dx*dx + dy*dy);
+QSize
+CQColorSwatches::
+sizeHint() const
+{
+  int s = swatchSize();
 
-      if (r < ri_ || r > ro_)
-        continue;
+  return QSize(int(colors_.size())*(s + 2) + 2, s + 4);
+}
 
-      double a = atan2(dy, dx);
+//------
 
-      if (a < 0) a = 2*M_PI + a;
+CQColorImagePreview::
+CQColorImagePreview(CQColorSelector *stroke) :
+ stroke_(stroke)
+{
+  setObjectName("preview");
 
-      double hue = 0.5*a/M_PI;
+  setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
+}
 
-      QColor c;
+void
+CQColorImagePreview::
+setImage(const QImage &image)
+{
+  image_ = image;
 
-      c.setHslF(hue, 1, 0.5);
+  updateMapped();
+}
 
-      p.setPen(c);
+void
+CQColorImagePreview::
+setColors(const Colors &colors)
+{
+  colors_ = colors;
 
-      p.drawPoint(x, y);
-    }
-  }
+  updateMapped();
+}
 
-  //---
+void
+CQColorImagePreview::
+setDither(bool b)
+{
+  dither_ = b;
 
-  double la = h*M_PI*2;
+  updateMapped();
+}
 
-  double x1, y1, x2, y2;
+void
+CQColorImagePreview::
+resizeEvent(QResizeEvent *)
+{
+  updateMapped();
+}
 
-  angleToPoint(ri_, la, x1, y1);
-  angleToPoint(ro_, la, x2, y2);
+void
+CQColorImagePreview::
+updateMapped()
+{
+  mapped_ = QImage();
 
-  QColor lc;
+  if (! image_.isNull() && ! colors_.empty() && width() > 0 && height() > 0) {
+    // only map image pixels actually displayed
+    auto scaled = image_.scaled(size(), Qt::KeepAspectRatio, Qt::SmoothTransformation);
 
-  lc.setHslF(h, 1, 0.5);
+    CQColorPalette::MapOptions options;
 
-  p.setPen(toBW(lc));
+    options.distance = CQColorPalette::Distance::PERCEPTUAL;
+    options.dither   = dither_;
 
-  p.drawLine(int(x1), int(y1), int(x2), int(y2));
+    mapped_ = CQColorPalette::mapImage(scaled, colors_, options);
 
-  //---
+    CQColorCVD::simulateImage(mapped_, stroke_->cvdType());
+  }
 
-  // calc triangle corners
-  //
-  // p1 (xt1_, yt1_) is s=1, v=0.5
-  // p2 (xt2_, yt2_) is s=0, v=0
-  // p3 (xt3_, yt3_) is s=0, v=1
+  update();
+}
 
-  angleToPoint(ri_, la           , xt1_, yt1_);
-  angleToPoint(ri_, la + 2*M_PI/3, xt2_, yt2_);
-  angleToPoint(ri_, la + 4*M_PI/3, xt3_, yt3_);
+void
+CQColorImagePreview::
+paintEvent(QPaintEvent *)
+{
+  if (mapped_.isNull())
+    return;
 
-  // fill triangle
-  int pxmin = int(std::min(std::min(xt1_, xt2_), xt3_));
-  int pymin = int(std::min(std::min(yt1_, yt2_), yt3_));
-  int pxmax = int(std::max(std::max(xt1_, xt2_), xt3_) + 0.9999);
-  int pymax = int(std::max(std::max(yt1_, yt2_), yt3_) + 0.9999);
+  QPainter p(this);
 
-  int    minX = pressX_;
-  int    minY = pressY_;
-  double minD = 999;
+  int x = (width () - mapped_.width ())/2;
+  int y = (height() - mapped_.height())/2;
 
-  for (int y = pymin; y <= pymax; ++y) {
-    //double y1 = ps_ - 1 - y;
+  p.drawImage(x, y, mapped_);
+}
 
-    for (int x = pxmin; x <= pxmax; ++x) {
-      double b1, b2, b3;
+QSize
+CQColorImagePreview::
+sizeHint() const
+{
+  return QSize(128, 96);
+}
 
-      if (! toBarycentric(x, y, b1, b2, b3))
-        continue;
+//------
 
-      double s1 = b2;
-      double l1 = b2*0.5 + b1;
+namespace {
 
-      QColor c;
+// get hex digit value (-1 if not hex digit)
+inline int hexValue(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
 
-      c.setHslF(h, s1, l1);
+inline bool isSpace(char c) {
+  return isspace(uchar(c));
+}
 
-      p.setPen(c);
+// tokens of CSS color function (latin1, no allocation)
+class CSSParser {
+ public:
+  CSSParser(const char *str, int len) :
+   str_(str), len_(len) {
+  }
 
-      p.drawPoint(x, y);
+  // read lower case name (up to 7 chars)
+  std::string readName() {
+    skipSpace();
 
-      double d = hypot(s1 - s, l1 - l);
+    std::string name;
 
-      if (d < minD) {
-        minD = d;
-        minX = x;
-        minY = y;
-      }
-    }
+    while (pos_ < len_ && isalpha(uchar(str_[pos_])) && name.size() < 7)
+      name += char(tolower(uchar(str_[pos_++])));
+
+    return name;
   }
 
-  p.setPen(toBW(qc));
+  // read char if next (after space)
+  bool readChar(char c) {
+    skipSpace();
 
-  p.drawEllipse(QRect(minX - 3, minY - 3, 6, 6));
-}
+    if (pos_ >= len_ || str_[pos_] != c)
+      return false;
 
-double
-CQColorSelectorWheel::
-pointLineDistance(double x, double y, double xl1, double yl1, double xl2, double yl2)
-{
-  //double plx = x - xl1;
-  //double ply = y - yl1;
+    ++pos_;
 
-  double dlx = xl2 - xl1;
-  double dly = yl2 - yl1;
+    return true;
+  }
 
-  double l = hypot(dlx, dly);
+  // read number with optional percent or deg suffix
+  bool readNumber(double &r, bool &percent) {
+    skipSpace();
 
-  double dot = xl2*yl1 - yl2*xl1;
+    int pos = pos_;
 
-  double d = fabs(dly*x - dlx*y + dot)/l;
+    bool negate = false;
 
-  return d;
-}
+    if      (pos_ < len_ && str_[pos_] == '-') { negate = true; ++pos_; }
+    else if (pos_ < len_ && str_[pos_] == '+') { ++pos_; }
 
-bool
-CQColorSelectorWheel::
-toBarycentric(double x, double y, double &b1, double &b2, double &b3)
-{
-  double area21 = triangleArea2(xt1_, yt1_, xt2_, yt2_, x, y);
-  double area22 = triangleArea2(xt2_, yt2_, xt3_, yt3_, x, y);
-  double area23 = triangleArea2(xt3_, yt3_, xt1_, yt1_, x, y);
+    r = 0.0;
 
-  bool s1 = (area21 < 0.0);
-  bool s2 = (area22 < 0.0);
-  bool s3 = (area23 < 0.0);
+    int numDigits = 0;
 
-  bool inside = ((s1 == s2) && (s2 == s3));
+    while (pos_ < len_ && isdigit(uchar(str_[pos_]))) {
+      r = r*10 + (str_[pos_++] - '0');
 
-  double area1 = 0.5*fabs(area21);
-  double area2 = 0.5*fabs(area22);
-  double area3 = 0.5*fabs(area23);
+      ++numDigits;
+    }
 
-  double is = 1.0/(area1 + area2 + area3);
+    if (pos_ < len_ && str_[pos_] == '.') {
+      ++pos_;
 
-  b1 = area1*is;
-  b2 = area2*is;
-  b3 = area3*is;
+      double f = 0.1;
 
-  return inside;
-}
+      while (pos_ < len_ && isdigit(uchar(str_[pos_]))) {
+        r += f*(str_[pos_++] - '0');
+        f *= 0.1;
 
-double
-CQColorSelectorWheel::
-triangleArea2(double x1, double y1, double x2, double y2, double x3, double y3)
-{
-  return (x2 - x1)*(y3 - y1) - (x3 - x1)*(y2 - y1);
-}
+        ++numDigits;
+      }
+    }
 
-void
-CQColorSelectorWheel::
-angleToPoint(double r, double a, double &x, double &y)
-{
-  x = xc_ + r*cos(a);
-  y = yc_ + r*sin(a);
+    if (numDigits == 0) {
+      pos_ = pos;
+      return false;
+    }
 
-  y = ps_ - 1 - y;
-}
+    if (negate)
+      r = -r;
 
-//------
+    percent = false;
 
-CQColorSpin::
-CQColorSpin(CQColorSelector *stroke, ColorType type) :
- QSpinBox(), stroke_(stroke), type_(type)
-{
-  setObjectName("spin");
+    if      (pos_ < len_ && str_[pos_] == '%') {
+      percent = true;
 
-  setSizePolicy(QSizePolicy::Fixed, QSizePolicy::Fixed);
+      ++pos_;
+    }
+    else if (pos_ + 2 < len_ && strncmp(&str_[pos_], "deg", 3) == 0)
+      pos_ += 3;
 
-  setRange(0, 255);
+    return true;
+  }
 
-  connect(this, SIGNAL(valueChanged(int)), this, SLOT(setColorSlot(int)));
-}
+  bool atEnd() {
+    skipSpace();
 
-void
-CQColorSpin::
-setColorSlot(int v)
-{
-  stroke_->setColorType(type_, v);
-}
+    return pos_ >= len_;
+  }
 
-//------
+ private:
+  void skipSpace() {
+    while (pos_ < len_ && isSpace(str_[pos_]))
+      ++pos_;
+  }
+
+ private:
+  const char *str_ { nullptr };
+  int         len_ { 0 };
+  int         pos_ { 0 };
+};
+
+}
 
 CQColorEdit::
 CQColorEdit(CQColorSelector *stroke, const QColor &c) :
@@ -1148,58 +3807,152 @@ valueChangedSlot()
 
   QColor c;
 
-  if (s.length() > 1 && s[0] == '#') {
-    if      (s.length() == 9) {
-      bool ok;
+  if (! parseColor(s, c))
+    return;
+
+  str_ = s;
+
+  setColor(c);
+
+  emit colorChanged(c_);
+}
+
+bool
+CQColorEdit::
+parseColor(const QString &str, QColor &c)
+{
+  auto latin1 = str.trimmed().toLatin1();
+
+  return parseColor(latin1.constData(), latin1.length(), c);
+}
+
+bool
+CQColorEdit::
+parseColor(const char *str, int len, QColor &c)
+{
+  // trim
+  while (len > 0 && isSpace(str[0]      )) { ++str; --len; }
+  while (len > 0 && isSpace(str[len - 1])) { --len; }
+
+  if (len <= 0)
+    return false;
+
+  //---
 
-      int r = s.mid(1, 2).toInt(&ok, 16); if (! ok) return;
-      int g = s.mid(3, 2).toInt(&ok, 16); if (! ok) return;
-      int b = s.mid(5, 2).toInt(&ok, 16); if (! ok) return;
-      int a = s.mid(7, 2).toInt(&ok, 16); if (! ok) return;
+  if (str[0] == '#') {
+    // #rgb, #rgba, #rrggbb or #rrggbbaa
+    int v[8];
 
-      c.setRgb(r, g, b, a);
+    for (int i = 1; i < len; ++i) {
+      if (i > 8 || (v[i - 1] = hexValue(str[i])) < 0)
+        return false;
     }
-    else if (s.length() == 7) {
-      bool ok;
 
-      int r = s.mid(1, 2).toInt(&ok, 16); if (! ok) return;
-      int g = s.mid(3, 2).toInt(&ok, 16); if (! ok) return;
-      int b = s.mid(5, 2).toInt(&ok, 16); if (! ok) return;
+    if      (len == 9)
+      c.setRgb(v[0]*16 + v[1], v[2]*16 + v[3], v[4]*16 + v[5], v[6]*16 + v[7]);
+    else if (len == 7)
+      c.setRgb(v[0]*16 + v[1], v[2]*16 + v[3], v[4]*16 + v[5]);
+    else if (len == 5)
+      c.setRgb(v[0]*17, v[1]*17, v[2]*17, v[3]*17);
+    else if (len == 4)
+      c.setRgb(v[0]*17, v[1]*17, v[2]*17);
+    else
+      return false;
+
+    return true;
+  }
+
+  //---
+
+  // CSS function
+  if (str[len - 1] == ')') {
+    CSSParser parser(str, len);
+
+    auto name = parser.readName();
+
+    enum class Func { RGB, HSL, CMYK };
+
+    Func func;
+
+    if      (name == "rgb"  || name == "rgba") func = Func::RGB;
+    else if (name == "hsl"  || name == "hsla") func = Func::HSL;
+    else if (name == "cmyk"                  ) func = Func::CMYK;
+    else return false;
+
+    if (! parser.readChar('('))
+      return false;
+
+    // three (four for cmyk) space or comma separated values, then optional alpha
+    // (after comma or slash)
+    int nv = (func == Func::CMYK ? 4 : 3);
+
+    double v[5];
+    bool   percent[5];
 
-      c.setRgb(r, g, b);
+    for (int i = 0; i < nv; ++i) {
+      if (i > 0)
+        parser.readChar(',');
+
+      if (! parser.readNumber(v[i], percent[i]))
+        return false;
     }
-    else if (s.length() == 5) {
-      bool ok;
 
-      int r = s.mid(1, 1).toInt(&ok, 16); if (! ok) return;
-      int g = s.mid(2, 1).toInt(&ok, 16); if (! ok) return;
-      int b = s.mid(3, 1).toInt(&ok, 16); if (! ok) return;
-      int a = s.mid(4, 1).toInt(&ok, 16); if (! ok) return;
+    double alpha = 1.0;
+
+    if (parser.readChar(',') || parser.readChar('/')) {
+      bool alphaPercent;
 
-      c.setRgb(r*16 + r, g*16 + g, b*16 + b, a*16 + a);
+      if (! parser.readNumber(alpha, alphaPercent))
+        return false;
+
+      if (alphaPercent)
+        alpha /= 100.0;
     }
-    else if (s.length() == 4) {
-      bool ok;
 
-      int r = s.mid(1, 1).toInt(&ok, 16); if (! ok) return;
-      int g = s.mid(2, 1).toInt(&ok, 16); if (! ok) return;
-      int b = s.mid(3, 1).toInt(&ok, 16); if (! ok) return;
+    if (! parser.readChar(')') || ! parser.atEnd())
+      return false;
+
+    //---
 
-      c.setRgb(r*16 + r, g*16 + g, b*16 + b);
+    auto clamp01 = [](double r) { return clamp(r, 0.0, 1.0); };
+
+    int a = int(clamp01(alpha)*255 + 0.5);
+
+    if      (func == Func::RGB) {
+      // 0-255 or percent
+      auto toByte = [&](int i) {
+        return int(clamp01(percent[i] ? v[i]/100.0 : v[i]/255.0)*255 + 0.5);
+      };
+
+      c.setRgb(toByte(0), toByte(1), toByte(2), a);
     }
-  }
-  else {
-    c = QColor(s);
-  }
+    else if (func == Func::HSL) {
+      // hue in degrees, saturation and lightness in percent
+      double h = std::fmod(v[0], 360.0)/360.0;
 
-  if (! c.isValid())
-    return;
+      if (h < 0.0) h += 1.0;
 
-  str_ = s;
+      double s = clamp01(v[1]/100.0);
+      double l = clamp01(v[2]/100.0);
 
-  setColor(c);
+      c = QColor::fromHslF(h, s, l, a/255.0);
+    }
+    else {
+      // percent (or 0-1)
+      auto toUnit = [&](int i) { return clamp01(percent[i] ? v[i]/100.0 : v[i]); };
 
-  emit colorChanged(c_);
+      c = QColor::fromCmykF(toUnit(0), toUnit(1), toUnit(2), toUnit(3), a/255.0);
+    }
+
+    return true;
+  }
+
+  //---
+
+  // color name
+  c = QColor(QLatin1String(str, len));
+
+  return c.isValid();
 }
 
 //------
@@ -1222,15 +3975,98 @@ setColor(const QColor &c)
   update();
 }
 
+void
+CQColorButton::
+setPopup(bool b)
+{
+  if (b == popup_)
+    return;
+
+  popup_ = b;
+
+  if (popup_) {
+    connect(this, SIGNAL(clicked()), this, SLOT(showPopupSlot()));
+
+    // construct selector now so first popup is only a show
+    CQColorSelectorPool::instance()->prewarm(1);
+  }
+  else
+    disconnect(this, SIGNAL(clicked()), this, SLOT(showPopupSlot()));
+}
+
+void
+CQColorButton::
+showPopupSlot()
+{
+  if (popupSelector_)
+    return;
+
+  popupSelector_ = CQColorSelectorPool::instance()->acquire(this, c_, Qt::Popup);
+
+  popupSelector_->installEventFilter(this);
+
+  connect(popupSelector_, SIGNAL(colorChanged(const QColor &)),
+          this, SLOT(popupColorSlot(const QColor &)));
+
+  popupSelector_->move(mapToGlobal(rect().bottomLeft()));
+
+  popupSelector_->show();
+}
+
+void
+CQColorButton::
+popupColorSlot(const QColor &c)
+{
+  setColor(c);
+
+  emit colorChanged(c);
+}
+
+bool
+CQColorButton::
+eventFilter(QObject *o, QEvent *e)
+{
+  // popup closed (click outside or escape)
+  if (o == popupSelector_ && e->type() == QEvent::Hide)
+    QTimer::singleShot(0, this, [this]() { releasePopup(); });
+
+  return false;
+}
+
+void
+CQColorButton::
+releasePopup()
+{
+  if (! popupSelector_ || popupSelector_->isVisible())
+    return;
+
+  popupSelector_->removeEventFilter(this);
+
+  CQColorSelectorPool::instance()->release(popupSelector_);
+
+  popupSelector_ = nullptr;
+}
+
 void
 CQColorButton::
 paintEvent(QPaintEvent *)
 {
   QPainter painter(this);
 
-  paintCheckerboard(&painter, 0, 0, width(), height(), 7);
+  drawColor(&painter, rect(), stroke_ ? stroke_->displayColor(c_) : c_);
+}
+
+void
+CQColorButton::
+drawColor(QPainter *painter, const QRect &rect, const QColor &c)
+{
+  painter->save();
+
+  painter->setClipRect(rect);
+
+  paintCheckerboard(painter, rect.x(), rect.y(), rect.width(), rect.height(), 7);
 
-  QBrush brush(c_);
+  painter->fillRect(rect, QBrush(c));
 
-  painter.fillRect(rect(), brush);
+  painter->restore();
 }
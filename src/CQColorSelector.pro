@@ -4,7 +4,7 @@ TARGET = CQColorSelector
 
 DEPENDPATH += .
 
-QT += widgets
+QT += widgets network
 
 QMAKE_CXXFLAGS += -std=c++17
 
@@ -13,9 +13,35 @@ CONFIG += staticlib
 # Input
 HEADERS += \
 ../include/CQColorSelector.h \
+../include/CQColorEyedropper.h \
+../include/CQColorPalette.h \
+../include/CQColorCVD.h \
+../include/CQColorStopEditor.h \
+../include/CQColorContrast.h \
+../include/CQColorSelectorPool.h \
+../include/CQColorDelegate.h \
+../include/CQColorAsyncPreview.h \
+../include/CQColorRenderCache.h \
+../include/CQColorHSL.h \
+../include/CQColorSRGB.h \
+../include/CQColorSync.h \
+../include/CQColorEventLog.h \
 
 SOURCES += \
 CQColorSelector.cpp \
+CQColorEyedropper.cpp \
+CQColorPalette.cpp \
+CQColorCVD.cpp \
+CQColorStopEditor.cpp \
+CQColorContrast.cpp \
+CQColorSelectorPool.cpp \
+CQColorDelegate.cpp \
+CQColorAsyncPreview.cpp \
+CQColorRenderCache.cpp \
+CQColorHSL.cpp \
+CQColorSRGB.cpp \
+CQColorSync.cpp \
+CQColorEventLog.cpp \
 
 OBJECTS_DIR = ../obj
 
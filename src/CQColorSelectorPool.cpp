@@ -0,0 +1,131 @@
+#include <CQColorSelectorPool.h>
+#include <CQColorSelector.h>
+#include <QApplication>
+#include <QMetaMethod>
+#include <algorithm>
+
+CQColorSelectorPool *
+CQColorSelectorPool::
+instance()
+{
+  static CQColorSelectorPool *instance;
+
+  if (! instance) {
+    instance = new CQColorSelectorPool;
+
+    // widgets must be deleted before the application
+    QObject::connect(qApp, &QCoreApplication::aboutToQuit, []() { instance->clear(); });
+  }
+
+  return instance;
+}
+
+CQColorSelectorPool::
+CQColorSelectorPool()
+{
+}
+
+void
+CQColorSelectorPool::
+setMaxIdle(int n)
+{
+  maxIdle_ = std::max(n, 0);
+
+  while (int(idle_.size()) > maxIdle_) {
+    delete idle_.back();
+
+    idle_.pop_back();
+  }
+}
+
+void
+CQColorSelectorPool::
+prewarm(int n)
+{
+  n = std::min(n, maxIdle_);
+
+  while (int(idle_.size()) < n)
+    idle_.push_back(create());
+}
+
+CQColorSelector *
+CQColorSelectorPool::
+acquire(QWidget *parent, const QColor &c, Qt::WindowFlags flags)
+{
+  CQColorSelector *selector;
+
+  if (! idle_.empty()) {
+    selector = idle_.back();
+
+    idle_.pop_back();
+  }
+  else
+    selector = create();
+
+  selector->setParent(parent, flags);
+
+  selector->setColor(c);
+  selector->clearHistory();
+
+  return selector;
+}
+
+void
+CQColorSelectorPool::
+release(CQColorSelector *selector)
+{
+  if (! selector)
+    return;
+
+  // tell helpers still holding selector (before their connection is removed)
+  emit selector->released();
+
+  // disconnect consumers from selector signals (widget and selector signals have no
+  // internal receivers). QObject signals (destroyed) are kept so helpers tracking the
+  // selector are told when it is deleted
+  auto *mo = selector->metaObject();
+
+  for (int i = QObject::staticMetaObject.methodCount(); i < mo->methodCount(); ++i) {
+    auto method = mo->method(i);
+
+    if (method.methodType() == QMetaMethod::Signal)
+      QObject::disconnect(selector, method, nullptr, QMetaMethod());
+  }
+
+  selector->hide();
+  selector->setParent(nullptr);
+
+  // clear hooks and state set by previous consumer
+  selector->resetState();
+
+  if (int(idle_.size()) < maxIdle_)
+    idle_.push_back(selector);
+  else
+    delete selector;
+}
+
+void
+CQColorSelectorPool::
+clear()
+{
+  for (auto *selector : idle_)
+    delete selector;
+
+  idle_.clear();
+}
+
+CQColorSelector *
+CQColorSelectorPool::
+create()
+{
+  auto *selector = new CQColorSelector;
+
+  selector->hide();
+
+  // force layout so first show does not need to calculate it
+  selector->adjustSize();
+
+  ++numCreated_;
+
+  return selector;
+}
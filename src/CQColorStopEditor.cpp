@@ -0,0 +1,555 @@
+#include <CQColorStopEditor.h>
+#include <CQColorSelector.h>
+#include <CQColorSRGB.h>
+#include <QPainter>
+#include <QPainterPath>
+#include <QMouseEvent>
+#include <QKeyEvent>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const int MARGIN   = 6;
+const int MARKER_H = 10;
+
+double clamp(double value, double l, double h) {
+  return std::min(std::max(value, l), h);
+}
+
+void paintCheckerboard(QPainter *p, const QRect &rect, int s) {
+  for (int y = rect.top(), iy = 0; y <= rect.bottom(); y += s, ++iy) {
+    for (int x = rect.left(), ix = 0; x <= rect.right(); x += s, ++ix) {
+      QColor c = (((ix + iy) & 1) ? QColor(96, 96, 96) : QColor(160, 160, 160));
+
+      p->fillRect(QRect(x, y, s, s).intersected(rect), QBrush(c));
+    }
+  }
+}
+
+}
+
+//------
+
+CQColorStopEditor::
+CQColorStopEditor(QWidget *parent, CQColorSelector *selector) :
+ QWidget(parent)
+{
+  setObjectName("stopEditor");
+
+  setFocusPolicy(Qt::StrongFocus);
+
+  setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
+
+  stops_.push_back(Stop(0.0, QColor(0, 0, 0)));
+  stops_.push_back(Stop(1.0, QColor(255, 255, 255)));
+
+  setSelector(selector);
+}
+
+void
+CQColorStopEditor::
+setStops(const Stops &stops)
+{
+  // at least one stop needed
+  if (stops.empty())
+    return;
+
+  stops_ = stops;
+
+  dragStop_ = -1;
+
+  for (auto &stop : stops_)
+    stop.pos = clamp(stop.pos, 0.0, 1.0);
+
+  current_ = std::min(std::max(current_, 0), int(stops_.size()) - 1);
+
+  stopsUpdated();
+
+  updateSelector();
+}
+
+int
+CQColorStopEditor::
+addStop(double pos, const QColor &color)
+{
+  stops_.push_back(Stop(clamp(pos, 0.0, 1.0), color));
+
+  stopsUpdated();
+
+  return int(stops_.size()) - 1;
+}
+
+void
+CQColorStopEditor::
+removeStop(int i)
+{
+  if (stops_.size() <= 2 || i < 0 || i >= int(stops_.size()))
+    return;
+
+  stops_.erase(stops_.begin() + i);
+
+  if (current_ >= int(stops_.size()))
+    current_ = int(stops_.size()) - 1;
+
+  stopsUpdated();
+
+  updateSelector();
+
+  emit currentStopChanged(current_);
+}
+
+void
+CQColorStopEditor::
+setCurrentStop(int i)
+{
+  if (i < 0 || i >= int(stops_.size()) || i == current_)
+    return;
+
+  current_ = i;
+
+  // only markers change
+  update();
+
+  updateSelector();
+
+  emit currentStopChanged(current_);
+}
+
+void
+CQColorStopEditor::
+setSpace(Space space)
+{
+  if (space == space_)
+    return;
+
+  space_ = space;
+
+  stripValid_ = false;
+
+  update();
+}
+
+void
+CQColorStopEditor::
+setSelector(CQColorSelector *selector)
+{
+  if (selector_)
+    disconnect(selector_, SIGNAL(colorChanged(const QColor &)),
+               this, SLOT(selectorColorSlot(const QColor &)));
+
+  selector_ = selector;
+
+  if (selector_)
+    connect(selector_, SIGNAL(colorChanged(const QColor &)),
+            this, SLOT(selectorColorSlot(const QColor &)));
+
+  updateSelector();
+}
+
+void
+CQColorStopEditor::
+updateSelector()
+{
+  if (! selector_ || stops_.empty())
+    return;
+
+  updatingColor_ = true;
+
+  selector_->setColor(stops_[current_].color);
+
+  updatingColor_ = false;
+}
+
+void
+CQColorStopEditor::
+selectorColorSlot(const QColor &c)
+{
+  if (updatingColor_ || stops_.empty())
+    return;
+
+  if (stops_[current_].color == c)
+    return;
+
+  stops_[current_].color = c;
+
+  stopsUpdated();
+}
+
+void
+CQColorStopEditor::
+stopsUpdated()
+{
+  stripValid_ = false;
+
+  update();
+
+  emit stopsChanged();
+}
+
+std::vector<int>
+CQColorStopEditor::
+sortedStops() const
+{
+  std::vector<int> inds(stops_.size());
+
+  for (int i = 0; i < int(inds.size()); ++i)
+    inds[i] = i;
+
+  std::stable_sort(inds.begin(), inds.end(), [&](int i1, int i2) {
+    return stops_[i1].pos < stops_[i2].pos;
+  });
+
+  return inds;
+}
+
+QColor
+CQColorStopEditor::
+interpColor(const QColor &c1, const QColor &c2, double f) const
+{
+  double a = c1.alphaF() + (c2.alphaF() - c1.alphaF())*f;
+
+  if      (space_ == Space::LINEAR_RGB) {
+    auto lerpLinear = [&](double v1, double v2) {
+      double l1 = CQColorSRGB::toLinear(v1);
+      double l2 = CQColorSRGB::toLinear(v2);
+
+      return clamp(CQColorSRGB::fromLinear(l1 + (l2 - l1)*f), 0.0, 1.0);
+    };
+
+    return QColor::fromRgbF(lerpLinear(c1.redF  (), c2.redF  ()),
+                            lerpLinear(c1.greenF(), c2.greenF()),
+                            lerpLinear(c1.blueF (), c2.blueF ()), a);
+  }
+  else if (space_ == Space::HSL) {
+    double h1, s1, l1, a1, h2, s2, l2, a2;
+
+    c1.getHslF(&h1, &s1, &l1, &a1);
+    c2.getHslF(&h2, &s2, &l2, &a2);
+
+    // achromatic colors take hue of other color
+    if (h1 < 0.0) h1 = std::max(h2, 0.0);
+    if (h2 < 0.0) h2 = h1;
+
+    // shortest hue path
+    double dh = h2 - h1;
+
+    if (dh >  0.5) dh -= 1.0;
+    if (dh < -0.5) dh += 1.0;
+
+    double h = std::fmod(h1 + dh*f + 1.0, 1.0);
+
+    return QColor::fromHslF(h, clamp(s1 + (s2 - s1)*f, 0.0, 1.0),
+                            clamp(l1 + (l2 - l1)*f, 0.0, 1.0), a);
+  }
+  else {
+    return QColor::fromRgbF(c1.redF  () + (c2.redF  () - c1.redF  ())*f,
+                            c1.greenF() + (c2.greenF() - c1.greenF())*f,
+                            c1.blueF () + (c2.blueF () - c1.blueF ())*f, a);
+  }
+}
+
+QColor
+CQColorStopEditor::
+interpColor(double pos) const
+{
+  if (stops_.empty())
+    return QColor();
+
+  auto inds = sortedStops();
+
+  if (pos <= stops_[inds.front()].pos) return stops_[inds.front()].color;
+  if (pos >= stops_[inds.back ()].pos) return stops_[inds.back ()].color;
+
+  for (int i = 1; i < int(inds.size()); ++i) {
+    const auto &stop1 = stops_[inds[i - 1]];
+    const auto &stop2 = stops_[inds[i    ]];
+
+    if (pos > stop2.pos)
+      continue;
+
+    double d = stop2.pos - stop1.pos;
+
+    double f = (d > 0.0 ? (pos - stop1.pos)/d : 0.0);
+
+    return interpColor(stop1.color, stop2.color, f);
+  }
+
+  return stops_[inds.back()].color;
+}
+
+QGradientStops
+CQColorStopEditor::
+gradientStops(int samplesPerSegment) const
+{
+  QGradientStops gstops;
+
+  auto inds = sortedStops();
+
+  for (int i = 0; i < int(inds.size()); ++i) {
+    const auto &stop = stops_[inds[i]];
+
+    // Qt interpolates in RGB so add samples between stops for other spaces
+    if (i > 0 && space_ != Space::RGB) {
+      const auto &stop1 = stops_[inds[i - 1]];
+
+      for (int j = 1; j < samplesPerSegment; ++j) {
+        double f = double(j)/samplesPerSegment;
+
+        gstops.push_back(QGradientStop(stop1.pos + (stop.pos - stop1.pos)*f,
+                                       interpColor(stop1.color, stop.color, f)));
+      }
+    }
+
+    gstops.push_back(QGradientStop(stop.pos, stop.color));
+  }
+
+  return gstops;
+}
+
+void
+CQColorStopEditor::
+updateStrip()
+{
+  int w = std::max(barRect().width(), 1);
+
+  strip_ = QImage(w, 1, QImage::Format_ARGB32);
+
+  auto *line = reinterpret_cast<QRgb *>(strip_.scanLine(0));
+
+  auto inds = sortedStops();
+
+  int ni = int(inds.size());
+
+  if (ni == 0) {
+    strip_.fill(0);
+
+    stripValid_ = true;
+
+    return;
+  }
+
+  // walk stops with pixels (single pass)
+  int i = 0;
+
+  for (int x = 0; x < w; ++x) {
+    double pos = (w > 1 ? double(x)/(w - 1) : 0.0);
+
+    while (i < ni && stops_[inds[i]].pos < pos)
+      ++i;
+
+    QColor c;
+
+    if      (i == 0)
+      c = stops_[inds[0]].color;
+    else if (i >= ni)
+      c = stops_[inds[ni - 1]].color;
+    else {
+      const auto &stop1 = stops_[inds[i - 1]];
+      const auto &stop2 = stops_[inds[i    ]];
+
+      double d = stop2.pos - stop1.pos;
+
+      c = interpColor(stop1.color, stop2.color, d > 0.0 ? (pos - stop1.pos)/d : 0.0);
+    }
+
+    line[x] = c.rgba();
+  }
+
+  stripValid_ = true;
+
+  ++numStripUpdates_;
+}
+
+QRect
+CQColorStopEditor::
+barRect() const
+{
+  return QRect(MARGIN, 1, width() - 2*MARGIN, height() - MARKER_H - 3);
+}
+
+int
+CQColorStopEditor::
+posToPixel(double pos) const
+{
+  auto rect = barRect();
+
+  return rect.left() + int(pos*(rect.width() - 1) + 0.5);
+}
+
+double
+CQColorStopEditor::
+pixelToPos(int x) const
+{
+  auto rect = barRect();
+
+  return clamp(double(x - rect.left())/std::max(rect.width() - 1, 1), 0.0, 1.0);
+}
+
+int
+CQColorStopEditor::
+stopAt(const QPoint &p) const
+{
+  // check current stop first so it can be dragged off others
+  int ymin = barRect().bottom();
+
+  if (p.y() < ymin)
+    return -1;
+
+  auto hit = [&](int i) {
+    return std::abs(posToPixel(stops_[i].pos) - p.x()) <= MARGIN;
+  };
+
+  if (current_ < int(stops_.size()) && hit(current_))
+    return current_;
+
+  for (int i = 0; i < int(stops_.size()); ++i)
+    if (hit(i))
+      return i;
+
+  return -1;
+}
+
+void
+CQColorStopEditor::
+resizeEvent(QResizeEvent *)
+{
+  stripValid_ = false;
+}
+
+void
+CQColorStopEditor::
+paintEvent(QPaintEvent *)
+{
+  QPainter p(this);
+
+  auto rect = barRect();
+
+  if (! stripValid_)
+    updateStrip();
+
+  paintCheckerboard(&p, rect, 6);
+
+  p.drawImage(rect, strip_);
+
+  p.setPen(QColor(0, 0, 0));
+  p.drawRect(rect.adjusted(0, 0, -1, -1));
+
+  //---
+
+  // stop markers (current drawn last)
+  p.setRenderHint(QPainter::Antialiasing);
+
+  auto drawMarker = [&](int i) {
+    const auto &stop = stops_[i];
+
+    double x  = posToPixel(stop.pos) + 0.5;
+    double y1 = rect.bottom() + 1;
+    double y2 = y1 + MARKER_H;
+
+    QPainterPath path;
+
+    path.moveTo(x, y1);
+    path.lineTo(x + MARGIN - 1, y1 + MARKER_H/2.0);
+    path.lineTo(x + MARGIN - 1, y2);
+    path.lineTo(x - MARGIN + 1, y2);
+    path.lineTo(x - MARGIN + 1, y1 + MARKER_H/2.0);
+    path.closeSubpath();
+
+    bool current = (i == current_);
+
+    p.setPen  (current ? palette().highlight().color() : QColor(0, 0, 0));
+    p.setBrush(QColor(stop.color.rgb()));
+
+    p.drawPath(path);
+  };
+
+  for (int i = 0; i < int(stops_.size()); ++i)
+    if (i != current_)
+      drawMarker(i);
+
+  if (current_ < int(stops_.size()))
+    drawMarker(current_);
+}
+
+void
+CQColorStopEditor::
+mousePressEvent(QMouseEvent *e)
+{
+  int i = stopAt(e->pos());
+
+  if (i < 0)
+    return;
+
+  setCurrentStop(i);
+
+  dragStop_ = i;
+}
+
+void
+CQColorStopEditor::
+mouseMoveEvent(QMouseEvent *e)
+{
+  if (dragStop_ < 0)
+    return;
+
+  double pos = pixelToPos(e->pos().x());
+
+  if (pos == stops_[dragStop_].pos)
+    return;
+
+  stops_[dragStop_].pos = pos;
+
+  stopsUpdated();
+}
+
+void
+CQColorStopEditor::
+mouseReleaseEvent(QMouseEvent *)
+{
+  dragStop_ = -1;
+}
+
+void
+CQColorStopEditor::
+mouseDoubleClickEvent(QMouseEvent *e)
+{
+  if (stopAt(e->pos()) >= 0)
+    return;
+
+  // add stop with current interpolated color
+  double pos = pixelToPos(e->pos().x());
+
+  int i = addStop(pos, interpColor(pos));
+
+  setCurrentStop(i);
+}
+
+void
+CQColorStopEditor::
+keyPressEvent(QKeyEvent *e)
+{
+  if      (e->key() == Qt::Key_Delete || e->key() == Qt::Key_Backspace)
+    removeStop(current_);
+  else if (e->key() == Qt::Key_Left || e->key() == Qt::Key_Right) {
+    if (current_ < 0 || current_ >= int(stops_.size()))
+      return;
+
+    double d = (e->key() == Qt::Key_Left ? -1.0 : 1.0)/std::max(barRect().width() - 1, 1);
+
+    stops_[current_].pos = clamp(stops_[current_].pos + d, 0.0, 1.0);
+
+    stopsUpdated();
+  }
+  else
+    QWidget::keyPressEvent(e);
+}
+
+QSize
+CQColorStopEditor::
+sizeHint() const
+{
+  QFontMetrics fm(font());
+
+  return QSize(256, fm.height() + MARKER_H + 8);
+}
@@ -0,0 +1,352 @@
+#include <CQColorSync.h>
+#include <CQColorSelector.h>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QCoreApplication>
+#include <QTimer>
+#include <QtEndian>
+#include <algorithm>
+
+CQColorSync::
+CQColorSync(const QString &name, QObject *parent) :
+ QObject(parent), name_(name)
+{
+  setObjectName("colorSync");
+
+  // id to ignore own messages (unique per process and instance)
+  id_ = quint32(QCoreApplication::applicationPid())*2654435761u ^
+        quint32(quintptr(this) >> 4);
+
+  timer_ = new QTimer(this);
+
+  timer_->setSingleShot(true);
+  timer_->setInterval(coalesceInterval_);
+
+  connect(timer_, SIGNAL(timeout()), this, SLOT(flushSlot()));
+}
+
+CQColorSync::
+~CQColorSync()
+{
+  stop();
+}
+
+bool
+CQColorSync::
+start()
+{
+  if (isActive())
+    return true;
+
+  auto connectToServer = [&]() {
+    auto *socket = new QLocalSocket(this);
+
+    socket->connectToServer(name_);
+
+    if (! socket->waitForConnected(100)) {
+      delete socket;
+      return false;
+    }
+
+    socket_ = socket;
+
+    addSocket(socket_);
+
+    return true;
+  };
+
+  // connect to existing server
+  if (connectToServer())
+    return true;
+
+  // no server so become server
+  server_ = new QLocalServer(this);
+
+  if (! server_->listen(name_)) {
+    // another process may have just become server
+    if (connectToServer()) {
+      delete server_;
+      server_ = nullptr;
+      return true;
+    }
+
+    // remove stale endpoint left by crashed server
+    QLocalServer::removeServer(name_);
+
+    if (! server_->listen(name_)) {
+      delete server_;
+      server_ = nullptr;
+      return false;
+    }
+  }
+
+  connect(server_, SIGNAL(newConnection()), this, SLOT(newConnectionSlot()));
+
+  return true;
+}
+
+void
+CQColorSync::
+stop()
+{
+  timer_->stop();
+
+  hasPending_ = false;
+
+  for (auto *peer : peers_) {
+    disconnect(peer, nullptr, this, nullptr);
+
+    peer->deleteLater();
+  }
+
+  peers_.clear();
+
+  if (socket_) {
+    disconnect(socket_, nullptr, this, nullptr);
+
+    socket_->deleteLater();
+
+    socket_ = nullptr;
+  }
+
+  delete server_;
+
+  server_ = nullptr;
+}
+
+void
+CQColorSync::
+addSelector(CQColorSelector *selector)
+{
+  if (std::find(selectors_.begin(), selectors_.end(), selector) != selectors_.end())
+    return;
+
+  selectors_.push_back(selector);
+
+  connect(selector, SIGNAL(colorChanged(const QColor &)),
+          this, SLOT(selectorColorSlot(const QColor &)));
+  connect(selector, SIGNAL(destroyed(QObject *)),
+          this, SLOT(selectorDestroyedSlot(QObject *)));
+
+  // pooled selector is reused by another consumer after release so must not get
+  // remote colors
+  connect(selector, SIGNAL(released()), this, SLOT(selectorReleasedSlot()));
+}
+
+void
+CQColorSync::
+removeSelector(CQColorSelector *selector)
+{
+  auto p = std::find(selectors_.begin(), selectors_.end(), selector);
+
+  if (p == selectors_.end())
+    return;
+
+  selectors_.erase(p);
+
+  disconnect(selector, nullptr, this, nullptr);
+}
+
+void
+CQColorSync::
+setCoalesceInterval(int ms)
+{
+  coalesceInterval_ = std::max(ms, 0);
+
+  timer_->setInterval(coalesceInterval_);
+}
+
+void
+CQColorSync::
+sendColor(const QColor &c)
+{
+  if (applying_ || ! c.isValid())
+    return;
+
+  pending_    = c.rgba();
+  hasPending_ = true;
+
+  // first change is sent immediately, later ones at most once per interval
+  if (! timer_->isActive())
+    flushSlot();
+}
+
+void
+CQColorSync::
+flushSlot()
+{
+  if (! hasPending_)
+    return;
+
+  hasPending_ = false;
+
+  if (hasLast_ && pending_ == lastRgb_)
+    return;
+
+  lastRgb_ = pending_;
+  hasLast_ = true;
+
+  //---
+
+  uchar data[MESSAGE_SIZE];
+
+  qToBigEndian<quint32>(id_     , data    );
+  qToBigEndian<quint32>(pending_, data + 4);
+
+  write(QByteArray(reinterpret_cast<const char *>(data), MESSAGE_SIZE));
+
+  ++numSent_;
+
+  timer_->start();
+}
+
+void
+CQColorSync::
+newConnectionSlot()
+{
+  while (server_->hasPendingConnections()) {
+    auto *socket = server_->nextPendingConnection();
+
+    peers_.push_back(socket);
+
+    addSocket(socket);
+  }
+}
+
+void
+CQColorSync::
+addSocket(QLocalSocket *socket)
+{
+  connect(socket, SIGNAL(readyRead()), this, SLOT(readSlot()));
+  connect(socket, SIGNAL(disconnected()), this, SLOT(disconnectedSlot()));
+}
+
+void
+CQColorSync::
+readSlot()
+{
+  auto *socket = qobject_cast<QLocalSocket *>(sender());
+  if (! socket) return;
+
+  // only last complete message of burst is relayed and applied
+  QByteArray last;
+
+  while (socket->bytesAvailable() >= MESSAGE_SIZE) {
+    last = socket->read(MESSAGE_SIZE);
+
+    ++numReceived_;
+  }
+
+  if (last.size() != MESSAGE_SIZE)
+    return;
+
+  // server relays to all other peers
+  if (server_)
+    write(last, socket);
+
+  auto *data = reinterpret_cast<const uchar *>(last.constData());
+
+  quint32 id  = qFromBigEndian<quint32>(data    );
+  QRgb    rgb = qFromBigEndian<quint32>(data + 4);
+
+  if (id == id_)
+    return;
+
+  // remote color is current so not sent back
+  lastRgb_ = rgb;
+  hasLast_ = true;
+
+  auto c = QColor::fromRgba(rgb);
+
+  applyColor(c);
+
+  ++numApplied_;
+
+  emit colorReceived(c);
+}
+
+void
+CQColorSync::
+disconnectedSlot()
+{
+  auto *socket = qobject_cast<QLocalSocket *>(sender());
+  if (! socket) return;
+
+  disconnect(socket, nullptr, this, nullptr);
+
+  socket->deleteLater();
+
+  if (socket == socket_) {
+    socket_ = nullptr;
+
+    // server went away so reconnect (or become server)
+    start();
+  }
+  else {
+    auto p = std::find(peers_.begin(), peers_.end(), socket);
+
+    if (p != peers_.end())
+      peers_.erase(p);
+  }
+}
+
+void
+CQColorSync::
+write(const QByteArray &msg, QLocalSocket *skip)
+{
+  if (socket_)
+    socket_->write(msg);
+
+  for (auto *peer : peers_) {
+    if (peer != skip)
+      peer->write(msg);
+  }
+}
+
+void
+CQColorSync::
+selectorColorSlot(const QColor &c)
+{
+  // ignore changes made by applying remote (or other local selector) color
+  if (applying_)
+    return;
+
+  applyColor(c, qobject_cast<CQColorSelector *>(sender()));
+
+  sendColor(c);
+}
+
+void
+CQColorSync::
+selectorReleasedSlot()
+{
+  auto *selector = qobject_cast<CQColorSelector *>(sender());
+
+  if (selector)
+    removeSelector(selector);
+}
+
+void
+CQColorSync::
+selectorDestroyedSlot(QObject *obj)
+{
+  auto p = std::find_if(selectors_.begin(), selectors_.end(),
+    [&](CQColorSelector *selector) { return static_cast<QObject *>(selector) == obj; });
+
+  if (p != selectors_.end())
+    selectors_.erase(p);
+}
+
+void
+CQColorSync::
+applyColor(const QColor &c, CQColorSelector *skip)
+{
+  applying_ = true;
+
+  for (auto *selector : selectors_) {
+    if (selector != skip)
+      selector->setColor(c);
+  }
+
+  applying_ = false;
+}
@@ -0,0 +1,642 @@
+// Headless command driver for CQColorSelector.
+//
+// Reads one command per line from stdin (or a script file) and runs it against an
+// offscreen selector, reporting the time taken by each command:
+//
+//   color <color>                      set color (name or #hex)
+//   channel <type> <value>             set channel value (0-1)
+//   expect <color> [<tolerance>]       check color (max channel difference 0-255)
+//   tab <rgb|hsl|cmyk|wheel>           show tab
+//   size <w> <h>                       resize selector
+//   cvd <none|protan|deutan|tritan>    set color vision deficiency simulation
+//   reference <color|none>             set contrast reference color
+//   drag <type> <from> <to> [<steps>]  drag channel gradient between values (0-1)
+//   render <file> [<w> <h>]            save selector image (PNG)
+//   replay <file> [original|max]       replay recorded input (frame time histogram)
+//   hslcheck [<steps>]                 compare HSL table with QColor over grid (error <= 1)
+//   hslbench [<count>]                 time HSL table and QColor conversions
+//   gradbench [<count>] [<w> <h>]      time RGB/alpha rows with gradient brush and strip
+//   stats                              print render cache and widget stats
+//   reset                              reset stats
+//   quit
+//
+// Channel types are r, g, b, h, s, l, c, m, y, k and a. Each command prints
+// "ok <command> <ms>" (plus command results) or "error <command> <message>".
+// Exit status is 1 if any command failed.
+
+#include <CQColorSelector.h>
+#include <CQColorRenderCache.h>
+#include <CQColorEventLog.h>
+#include <CQColorHSL.h>
+
+#include <QApplication>
+#include <QMouseEvent>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QFile>
+#include <QTextStream>
+#include <iostream>
+#include <algorithm>
+#include <cstdlib>
+#include <map>
+#include <string>
+
+namespace {
+
+using ColorType = CQColorSelector::ColorType;
+
+bool stringToType(const QString &str, ColorType &type) {
+  static std::map<QString, ColorType> types = {
+    { "r", ColorType::RGB_R  }, { "g", ColorType::RGB_G  }, { "b", ColorType::RGB_B  },
+    { "h", ColorType::HSL_H  }, { "s", ColorType::HSL_S  }, { "l", ColorType::HSL_L  },
+    { "c", ColorType::CMYK_C }, { "m", ColorType::CMYK_M }, { "y", ColorType::CMYK_Y },
+    { "k", ColorType::CMYK_K }, { "a", ColorType::ALPHA  } };
+
+  auto p = types.find(str.toLower());
+
+  if (p == types.end())
+    return false;
+
+  type = (*p).second;
+
+  return true;
+}
+
+bool stringToColor(const QString &str, QColor &c) {
+  c = QColor(str);
+
+  return c.isValid();
+}
+
+class Driver {
+ public:
+  Driver() {
+    CQColorSelector::Config config;
+
+    config.cmykTab    = true;
+    config.eyedropper = false;
+
+    selector_ = new CQColorSelector(nullptr, config);
+
+    selector_->resize(400, 300);
+
+    selector_->show();
+
+    QApplication::processEvents();
+  }
+
+ ~Driver() {
+    delete selector_;
+  }
+
+  // run command line, returns false to quit
+  bool exec(const QString &line) {
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+    auto words = line.simplified().split(' ', Qt::SkipEmptyParts);
+#else
+    auto words = line.simplified().split(' ', QString::SkipEmptyParts);
+#endif
+
+    if (words.empty() || words[0].startsWith("#"))
+      return true;
+
+    auto cmd = words[0];
+
+    words.pop_front();
+
+    if (cmd == "quit" || cmd == "exit")
+      return false;
+
+    QElapsedTimer timer;
+
+    timer.start();
+
+    QString msg;
+
+    bool rc = run(cmd, words, msg);
+
+    // include repaint of changes in command time
+    QApplication::processEvents();
+
+    double ms = timer.nsecsElapsed()/1E6;
+
+    if (rc)
+      std::cout << "ok " << cmd.toStdString() << " " << ms << "ms";
+    else {
+      std::cout << "error " << cmd.toStdString();
+
+      ++numErrors_;
+    }
+
+    if (msg != "")
+      std::cout << " " << msg.toStdString();
+
+    std::cout << std::endl;
+
+    return true;
+  }
+
+  int numErrors() const { return numErrors_; }
+
+ private:
+  bool run(const QString &cmd, const QStringList &args, QString &msg) {
+    if      (cmd == "color") {
+      QColor c;
+
+      if (args.size() != 1 || ! stringToColor(args[0], c)) {
+        msg = "usage: color <color>";
+        return false;
+      }
+
+      selector_->setColor(c);
+    }
+    else if (cmd == "channel") {
+      ColorType type;
+
+      if (args.size() != 2 || ! stringToType(args[0], type)) {
+        msg = "usage: channel <type> <value>";
+        return false;
+      }
+
+      selector_->setColorTypeF(type, args[1].toDouble());
+    }
+    else if (cmd == "expect") {
+      QColor c;
+
+      if (args.size() < 1 || args.size() > 2 || ! stringToColor(args[0], c)) {
+        msg = "usage: expect <color> [<tolerance>]";
+        return false;
+      }
+
+      return expect(c, args.size() > 1 ? args[1].toInt() : 0, msg);
+    }
+    else if (cmd == "tab") {
+      using ColorMode = CQColorSelector::ColorMode;
+
+      auto name = (args.size() == 1 ? args[0].toLower() : QString());
+
+      ColorMode mode;
+
+      if      (name == "rgb"  ) mode = ColorMode::RGB;
+      else if (name == "hsl"  ) mode = ColorMode::HSL;
+      else if (name == "cmyk" ) mode = ColorMode::CMYK;
+      else if (name == "wheel") mode = ColorMode::WHEEL;
+      else {
+        msg = "usage: tab <rgb|hsl|cmyk|wheel>";
+        return false;
+      }
+
+      if (! selector_->setMode(mode)) {
+        msg = "no tab " + name;
+        return false;
+      }
+    }
+    else if (cmd == "size") {
+      if (args.size() != 2) {
+        msg = "usage: size <w> <h>";
+        return false;
+      }
+
+      selector_->resize(args[0].toInt(), args[1].toInt());
+    }
+    else if (cmd == "cvd") {
+      using CVDType = CQColorCVD::Type;
+
+      auto name = (args.size() == 1 ? args[0].toLower() : QString());
+
+      if      (name == "none"  ) selector_->setCvdType(CVDType::NONE);
+      else if (name == "protan") selector_->setCvdType(CVDType::PROTAN);
+      else if (name == "deutan") selector_->setCvdType(CVDType::DEUTAN);
+      else if (name == "tritan") selector_->setCvdType(CVDType::TRITAN);
+      else {
+        msg = "usage: cvd <none|protan|deutan|tritan>";
+        return false;
+      }
+    }
+    else if (cmd == "reference") {
+      QColor c;
+
+      if (args.size() != 1 || (args[0] != "none" && ! stringToColor(args[0], c))) {
+        msg = "usage: reference <color|none>";
+        return false;
+      }
+
+      selector_->setReferenceColor(c);
+    }
+    else if (cmd == "drag") {
+      ColorType type;
+
+      if (args.size() < 3 || ! stringToType(args[0], type)) {
+        msg = "usage: drag <type> <from> <to> [<steps>]";
+        return false;
+      }
+
+      return drag(type, args[1].toDouble(), args[2].toDouble(),
+                  args.size() > 3 ? args[3].toInt() : 100, msg);
+    }
+    else if (cmd == "render") {
+      if (args.size() != 1 && args.size() != 3) {
+        msg = "usage: render <file> [<w> <h>]";
+        return false;
+      }
+
+      if (args.size() == 3) {
+        selector_->resize(args[1].toInt(), args[2].toInt());
+
+        QApplication::processEvents();
+      }
+
+      if (! selector_->grab().save(args[0], "PNG")) {
+        msg = "failed to write " + args[0];
+        return false;
+      }
+    }
+    else if (cmd == "replay") {
+      if (args.size() < 1 || args.size() > 2) {
+        msg = "usage: replay <file> [original|max]";
+        return false;
+      }
+
+      return replay(args[0], args.size() > 1 && args[1] == "max", msg);
+    }
+    else if (cmd == "hslcheck") {
+      return hslCheck(args.size() > 0 ? args[0].toInt() : 64, msg);
+    }
+    else if (cmd == "hslbench") {
+      hslBench(args.size() > 0 ? args[0].toInt() : 1000000, msg);
+    }
+    else if (cmd == "gradbench") {
+      if (args.size() != 0 && args.size() != 1 && args.size() != 3) {
+        msg = "usage: gradbench [<count>] [<w> <h>]";
+        return false;
+      }
+
+      int   count = (args.size() > 0 ? args[0].toInt() : 1000);
+      QSize size  = (args.size() > 2 ? QSize(args[1].toInt(), args[2].toInt()) :
+                                       QSize(256, 20));
+
+      gradBench(count, size, msg);
+    }
+    else if (cmd == "stats") {
+      stats();
+    }
+    else if (cmd == "reset") {
+      CQColorRenderCache::instance()->resetStats();
+
+      dragTimes_.clear();
+    }
+    else {
+      msg = "unknown command";
+      return false;
+    }
+
+    return true;
+  }
+
+  // check selector color is within tolerance of expected color
+  bool expect(const QColor &c, int tolerance, QString &msg) const {
+    QColor c1 = selector_->color();
+
+    int d = std::max({ std::abs(c1.red  () - c.red  ()), std::abs(c1.green() - c.green()),
+                       std::abs(c1.blue () - c.blue ()), std::abs(c1.alpha() - c.alpha()) });
+
+    msg = QString("color %1").arg(c1.name(QColor::HexArgb));
+
+    return (d <= tolerance);
+  }
+
+  // get gradient widgets (QWidget without Q_OBJECT so qobject_cast and
+  // findChildren<CQColorGradient *> can't be used)
+  std::vector<CQColorGradient *> gradients() const {
+    std::vector<CQColorGradient *> gradients;
+
+    for (auto *w : selector_->findChildren<QWidget *>()) {
+      auto *gradient = dynamic_cast<CQColorGradient *>(w);
+
+      if (gradient)
+        gradients.push_back(gradient);
+    }
+
+    return gradients;
+  }
+
+  // drag visible gradient of type from value v1 to v2 (0-1) with mouse events,
+  // repainting after each move
+  bool drag(ColorType type, double v1, double v2, int steps, QString &msg) {
+    CQColorGradient *gradient = nullptr;
+
+    for (auto *gradient1 : gradients()) {
+      if (gradient1->type() == type && gradient1->isVisible()) {
+        gradient = gradient1;
+        break;
+      }
+    }
+
+    if (! gradient) {
+      msg = "no visible gradient for type";
+      return false;
+    }
+
+    steps = std::max(steps, 1);
+
+    auto valueToPos = [&](double v) {
+      return QPointF(std::min(std::max(v, 0.0), 1.0)*(gradient->width() - 1),
+                     gradient->height()/2.0);
+    };
+
+    auto sendMouse = [&](QEvent::Type etype, const QPointF &pos, Qt::MouseButtons buttons) {
+      QMouseEvent e(etype, pos, Qt::LeftButton, buttons, Qt::NoModifier);
+
+      QApplication::sendEvent(gradient, &e);
+    };
+
+    int numBackground = gradient->numBackgroundUpdates();
+
+    sendMouse(QEvent::MouseButtonPress, valueToPos(v1), Qt::LeftButton);
+
+    QApplication::processEvents();
+
+    QElapsedTimer timer;
+
+    for (int i = 1; i <= steps; ++i) {
+      timer.start();
+
+      sendMouse(QEvent::MouseMove, valueToPos(v1 + (v2 - v1)*i/steps), Qt::LeftButton);
+
+      QApplication::processEvents();
+
+      dragTimes_.push_back(timer.nsecsElapsed()/1E6);
+    }
+
+    sendMouse(QEvent::MouseButtonRelease, valueToPos(v2), Qt::NoButton);
+
+    //---
+
+    auto times = std::vector<double>(dragTimes_.end() - steps, dragTimes_.end());
+
+    std::sort(times.begin(), times.end());
+
+    double sum = 0.0;
+
+    for (const auto &t : times)
+      sum += t;
+
+    msg = QString("steps %1 mean %2ms median %3ms max %4ms backgrounds %5").
+            arg(steps).arg(sum/steps).arg(times[steps/2]).arg(times.back()).
+            arg(gradient->numBackgroundUpdates() - numBackground);
+
+    return true;
+  }
+
+  // replay recorded event log and print frame time histogram
+  bool replay(const QString &filename, bool maxSpeed, QString &msg) {
+    CQColorEventLog log;
+
+    if (! log.load(filename)) {
+      msg = "failed to read " + filename;
+      return false;
+    }
+
+    auto speed = (maxSpeed ? CQColorEventLog::Speed::MAX : CQColorEventLog::Speed::ORIGINAL);
+
+    auto stats = log.replay(selector_, speed);
+
+    const auto &limits = CQColorEventLog::histogramLimits();
+
+    double limit1 = 0.0;
+
+    for (size_t i = 0; i < limits.size(); ++i) {
+      std::cout << "hist " << limit1 << "-" << limits[i] << "ms " <<
+                   stats.histogram[i] << std::endl;
+
+      limit1 = limits[i];
+    }
+
+    msg = QString("events %1 skipped %2 mean %3ms max %4ms").
+            arg(stats.numEvents).arg(stats.numSkipped).arg(stats.meanMs).arg(stats.maxMs);
+
+    return true;
+  }
+
+  // compare HSL table conversion with QColor::fromHslF over h, s, l grid
+  bool hslCheck(int steps, QString &msg) {
+    steps = std::max(steps, 1);
+
+    bool enabled = CQColorHSL::isEnabled();
+
+    CQColorHSL::setEnabled(true);
+
+    int maxError = 0, numDiff = 0, num = 0;
+
+    for (int ih = 0; ih < 6*steps; ++ih) {
+      double h = double(ih)/(6*steps);
+
+      for (int is = 0; is <= steps; ++is) {
+        double s = double(is)/steps;
+
+        for (int il = 0; il <= steps; ++il) {
+          double l = double(il)/steps;
+
+          QRgb rgb1 = CQColorHSL::toRgb(h, s, l);
+          QRgb rgb2 = QColor::fromHslF(h, s, l).rgba();
+
+          int error = std::max({ std::abs(qRed  (rgb1) - qRed  (rgb2)),
+                                 std::abs(qGreen(rgb1) - qGreen(rgb2)),
+                                 std::abs(qBlue (rgb1) - qBlue (rgb2)) });
+
+          maxError = std::max(maxError, error);
+
+          if (error > 0)
+            ++numDiff;
+
+          ++num;
+        }
+      }
+    }
+
+    CQColorHSL::setEnabled(enabled);
+
+    msg = QString("colors %1 differ %2 maxError %3").arg(num).arg(numDiff).arg(maxError);
+
+    return (maxError <= 1);
+  }
+
+  // time count HSL conversions using table and QColor::fromHslF
+  void hslBench(int count, QString &msg) {
+    count = std::max(count, 1);
+
+    bool enabled = CQColorHSL::isEnabled();
+
+    auto timeConvert = [&](bool table) {
+      CQColorHSL::setEnabled(table);
+
+      QRgb sum = 0;
+
+      QElapsedTimer timer;
+
+      timer.start();
+
+      for (int i = 0; i < count; ++i) {
+        double h = (i % 360)/360.0;
+        double s = ((i/360) % 101)/100.0;
+        double l = ((i/36360) % 101)/100.0;
+
+        sum += CQColorHSL::toRgb(h, s, l);
+      }
+
+      // use result so loop is not optimized away
+      hslSink_ = sum;
+
+      return double(timer.nsecsElapsed())/count;
+    };
+
+    double tableNs  = timeConvert(true);
+    double qcolorNs = timeConvert(false);
+
+    CQColorHSL::setEnabled(enabled);
+
+    msg = QString("count %1 table %2ns qcolor %3ns speedup %4").
+            arg(count).arg(tableNs).arg(qcolorNs).arg(qcolorNs/std::max(tableNs, 1E-9));
+  }
+
+  // time count renders of each RGB and alpha row filled with gradient brush and with
+  // sampled strip. Any two of the r, g, b values determine the color index so (up to
+  // 65536) strip colors are unique and every sampled render misses the (emptied) render
+  // cache, other cached images (checkerboard) are shared by both
+  void gradBench(int count, const QSize &size, QString &msg) {
+    count = std::min(std::max(count, 1), 65536);
+
+    bool linear = CQColorGradient::isLinearFill();
+
+    CQColorRenderCache::instance()->clear();
+
+    auto timeRender = [&](ColorType type, bool linear1) {
+      CQColorGradient::setLinearFill(linear1);
+
+      QElapsedTimer timer;
+
+      timer.start();
+
+      for (int i = 0; i < count; ++i) {
+        int lo = i & 0xff, hi = (i >> 8) & 0xff;
+
+        QColor c(lo, hi, (lo + hi) & 0xff, 200);
+
+        CQColorGradient::renderImage(type, c, size);
+      }
+
+      return timer.nsecsElapsed()/1E6/count;
+    };
+
+    double linearSum = 0.0, sampledSum = 0.0;
+
+    std::vector<std::pair<std::string, ColorType>> types = {
+      { "r", ColorType::RGB_R }, { "g", ColorType::RGB_G }, { "b", ColorType::RGB_B },
+      { "a", ColorType::ALPHA } };
+
+    for (const auto &p : types) {
+      const auto &name = p.first;
+      auto        type = p.second;
+
+      double linearMs  = timeRender(type, true );
+      double sampledMs = timeRender(type, false);
+
+      std::cout << "bench " << name << " linear " << linearMs <<
+                   "ms sampled " << sampledMs << "ms" << std::endl;
+
+      linearSum  += linearMs;
+      sampledSum += sampledMs;
+    }
+
+    CQColorGradient::setLinearFill(linear);
+
+    msg = QString("count %1 size %2x%3 linear %4ms sampled %5ms speedup %6").
+            arg(count).arg(size.width()).arg(size.height()).arg(linearSum/4).
+            arg(sampledSum/4).arg(sampledSum/std::max(linearSum, 1E-9));
+  }
+
+  void stats() const {
+    auto printStat = [](const QString &name, double value) {
+      std::cout << "stat " << name.toStdString() << " " << value << std::endl;
+    };
+
+    auto cacheStats = CQColorRenderCache::instance()->stats();
+
+    printStat("cache.hits"     , cacheStats.hits);
+    printStat("cache.misses"   , cacheStats.misses);
+    printStat("cache.evictions", cacheStats.evictions);
+    printStat("cache.bytes"    , cacheStats.bytes);
+    printStat("cache.count"    , cacheStats.count);
+    printStat("cache.hitRate"  , cacheStats.hitRate());
+
+    if (! dragTimes_.empty()) {
+      double sum = 0.0;
+
+      for (const auto &t : dragTimes_)
+        sum += t;
+
+      printStat("drag.steps" , dragTimes_.size());
+      printStat("drag.meanMs", sum/dragTimes_.size());
+    }
+
+    printStat("history.size", selector_->history().size());
+
+    for (auto *gradient : gradients()) {
+      if (! gradient->isVisible())
+        continue;
+
+      auto name = QString("gradient.%1.").arg(int(gradient->type()));
+
+      const auto &input = gradient->tabletInput();
+
+      printStat(name + "backgrounds"  , gradient->numBackgroundUpdates());
+      printStat(name + "tabletApplied", input.numApplied());
+      printStat(name + "tabletMeanMs" , input.meanLatency());
+      printStat(name + "tabletMaxMs"  , input.maxLatency());
+    }
+  }
+
+ private:
+  CQColorSelector    *selector_ { nullptr };
+  std::vector<double> dragTimes_;
+  int                 numErrors_ { 0 };
+  volatile QRgb       hslSink_ { 0 };
+};
+
+}
+
+int
+main(int argc, char **argv)
+{
+  // no display needed
+  if (qgetenv("QT_QPA_PLATFORM").isEmpty())
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+
+  QApplication app(argc, argv);
+
+  QFile file;
+
+  if (argc > 1) {
+    file.setFileName(argv[1]);
+
+    if (! file.open(QIODevice::ReadOnly)) {
+      std::cerr << "Failed to open " << argv[1] << std::endl;
+      return 1;
+    }
+  }
+  else
+    file.open(stdin, QIODevice::ReadOnly);
+
+  Driver driver;
+
+  QTextStream ts(&file);
+
+  QString line;
+
+  while (ts.readLineInto(&line)) {
+    if (! driver.exec(line))
+      break;
+  }
+
+  return (driver.numErrors() > 0 ? 1 : 0);
+}
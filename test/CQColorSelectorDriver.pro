@@ -0,0 +1,23 @@
+TEMPLATE = app
+
+TARGET = CQColorSelectorDriver
+
+DEPENDPATH += .
+
+QT += widgets network
+
+QMAKE_CXXFLAGS += -std=c++14
+
+SOURCES += \
+CQColorSelectorDriver.cpp \
+
+DESTDIR     = .
+OBJECTS_DIR = .
+
+INCLUDEPATH += \
+../include \
+.
+
+unix:LIBS += \
+-L../lib \
+-lCQColorSelector
@@ -1,5 +1,7 @@
 #include <CQColorSelectorTest.h>
 #include <CQColorSelector.h>
+#include <CQColorSync.h>
+#include <CQColorEventLog.h>
 
 #include <QApplication>
 #include <QHBoxLayout>
@@ -9,17 +11,37 @@ main(int argc, char **argv)
 {
   QApplication app(argc, argv);
 
-  CQColorSelectorTest *test = new CQColorSelectorTest;
+  QString syncName, recordFile;
+
+  for (int i = 1; i < argc; ++i) {
+    if      (QString(argv[i]) == "-sync" && i < argc - 1)
+      syncName = argv[++i];
+    else if (QString(argv[i]) == "-record" && i < argc - 1)
+      recordFile = argv[++i];
+  }
+
+  CQColorSelectorTest *test = new CQColorSelectorTest(syncName);
 
   test->resize(400, 300);
 
   test->show();
 
-  return app.exec();
+  // record gradient/wheel input for replay (CQColorSelectorDriver replay command)
+  CQColorEventRecorder recorder;
+
+  if (recordFile != "")
+    recorder.start(test->selector());
+
+  int rc = app.exec();
+
+  if (recordFile != "")
+    recorder.log().save(recordFile);
+
+  return rc;
 }
 
 CQColorSelectorTest::
-CQColorSelectorTest()
+CQColorSelectorTest(const QString &syncName)
 {
   QHBoxLayout *layout = new QHBoxLayout(this);
   layout->setMargin(2); layout->setSpacing(2);
@@ -27,4 +49,13 @@ CQColorSelectorTest()
   stroke_ = new CQColorSelector;
 
   layout->addWidget(stroke_);
+
+  // share color with other instances started with same sync name
+  if (syncName != "") {
+    sync_ = new CQColorSync(syncName, this);
+
+    sync_->addSelector(stroke_);
+
+    sync_->start();
+  }
 }
@@ -1,13 +1,17 @@
 #include <QDialog>
 
 class CQColorSelector;
+class CQColorSync;
 
 class CQColorSelectorTest : public QDialog {
   Q_OBJECT
 
  public:
-  CQColorSelectorTest();
+  CQColorSelectorTest(const QString &syncName="");
+
+  CQColorSelector *selector() const { return stroke_; }
 
  private:
   CQColorSelector *stroke_;
+  CQColorSync     *sync_ { nullptr };
 };
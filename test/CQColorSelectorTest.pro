@@ -4,7 +4,7 @@ TARGET = CQColorSelectorTest
 
 DEPENDPATH += .
 
-QT += widgets
+QT += widgets network
 
 QMAKE_CXXFLAGS += -std=c++14
 
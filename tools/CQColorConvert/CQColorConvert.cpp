@@ -0,0 +1,337 @@
+// Batch color conversion.
+//
+// Reads one color per line from stdin (hex, color name or CSS rgb(), rgba(), hsl(),
+// hsla() or cmyk() function, parsed with CQColorEdit::parseColor) and writes it in the
+// requested format to stdout:
+//
+//   CQColorConvert [-format hex|rgb|hsl|cmyk] [-threads <n>] [-chunk <bytes>]
+//
+// Input is streamed in chunks of complete lines. With -threads (<= 0 for all cores)
+// each chunk is split into bands of lines converted in parallel and written in order.
+// Invalid colors are output as empty lines and counted (exit status 1).
+
+#include <CQColorSelector.h>
+#include <CQColorPalette.h>
+
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <iostream>
+
+namespace {
+
+enum class Format {
+  HEX,
+  RGB,
+  HSL,
+  CMYK
+};
+
+// append unsigned integer
+char *writeInt(char *p, int i) {
+  char buffer[16];
+
+  int n = 0;
+
+  do {
+    buffer[n++] = char('0' + i % 10);
+
+    i /= 10;
+  } while (i > 0);
+
+  while (n > 0)
+    *p++ = buffer[--n];
+
+  return p;
+}
+
+// append string
+char *writeStr(char *p, const char *str) {
+  while (*str)
+    *p++ = *str++;
+
+  return p;
+}
+
+// append two digit hex
+char *writeHex(char *p, int i) {
+  static const char *digits = "0123456789abcdef";
+
+  *p++ = digits[(i >> 4) & 0xf];
+  *p++ = digits[i & 0xf];
+
+  return p;
+}
+
+// append alpha (0-1, three decimals)
+char *writeAlpha(char *p, int a) {
+  int i = int(a*1000.0/255.0 + 0.5);
+
+  p = writeInt(p, i/1000);
+
+  *p++ = '.';
+
+  i %= 1000;
+
+  *p++ = char('0' + i/100);
+  *p++ = char('0' + (i/10) % 10);
+  *p++ = char('0' + i % 10);
+
+  return p;
+}
+
+inline int percent(double r) {
+  return int(r*100.0 + 0.5);
+}
+
+// append formatted color (at most 64 chars)
+char *writeColor(char *p, const QColor &c, Format format) {
+  int  a        = c.alpha();
+  bool hasAlpha = (a != 255);
+
+  if      (format == Format::HEX) {
+    *p++ = '#';
+
+    p = writeHex(p, c.red()); p = writeHex(p, c.green()); p = writeHex(p, c.blue());
+
+    if (hasAlpha)
+      p = writeHex(p, a);
+  }
+  else if (format == Format::RGB) {
+    p = writeStr(p, hasAlpha ? "rgba(" : "rgb(");
+
+    p = writeInt(p, c.red  ()); p = writeStr(p, ", ");
+    p = writeInt(p, c.green()); p = writeStr(p, ", ");
+    p = writeInt(p, c.blue ());
+
+    if (hasAlpha) {
+      p = writeStr(p, ", "); p = writeAlpha(p, a);
+    }
+
+    *p++ = ')';
+  }
+  else if (format == Format::HSL) {
+    double h, s, l, a1;
+
+    c.getHslF(&h, &s, &l, &a1);
+
+    // achromatic hue is -1
+    int ih = (h >= 0.0 ? int(h*360.0 + 0.5) % 360 : 0);
+
+    p = writeStr(p, hasAlpha ? "hsla(" : "hsl(");
+
+    p = writeInt(p, ih        ); p = writeStr(p, ", " );
+    p = writeInt(p, percent(s)); p = writeStr(p, "%, ");
+    p = writeInt(p, percent(l)); p = writeStr(p, "%"  );
+
+    if (hasAlpha) {
+      p = writeStr(p, ", "); p = writeAlpha(p, a);
+    }
+
+    *p++ = ')';
+  }
+  else {
+    double cc, m, y, k, a1;
+
+    c.getCmykF(&cc, &m, &y, &k, &a1);
+
+    p = writeStr(p, "cmyk(");
+
+    p = writeInt(p, percent(cc)); p = writeStr(p, "%, ");
+    p = writeInt(p, percent(m )); p = writeStr(p, "%, ");
+    p = writeInt(p, percent(y )); p = writeStr(p, "%, ");
+    p = writeInt(p, percent(k )); p = writeStr(p, "%"  );
+
+    if (hasAlpha) {
+      p = writeStr(p, ", "); p = writeAlpha(p, a);
+    }
+
+    *p++ = ')';
+  }
+
+  return p;
+}
+
+// convert lines in [start, end) (complete lines) appending to output, returns
+// number of invalid colors
+int convertLines(const char *start, const char *end, Format format, std::string &out) {
+  int numInvalid = 0;
+
+  // worst case output per line is bounded so write directly into resized string
+  size_t numLines = size_t(std::count(start, end, '\n'));
+
+  size_t pos = out.size();
+
+  out.resize(pos + numLines*64);
+
+  char *p = &out[pos];
+
+  QColor c;
+
+  while (start < end) {
+    auto *eol = static_cast<const char *>(memchr(start, '\n', size_t(end - start)));
+
+    int len = int(eol - start);
+
+    if (len > 0 && start[len - 1] == '\r')
+      --len;
+
+    if (len > 0) {
+      if (CQColorEdit::parseColor(start, len, c))
+        p = writeColor(p, c, format);
+      else
+        ++numInvalid;
+    }
+
+    *p++ = '\n';
+
+    start = eol + 1;
+  }
+
+  out.resize(size_t(p - out.data()));
+
+  return numInvalid;
+}
+
+}
+
+int
+main(int argc, char **argv)
+{
+  Format format     = Format::HEX;
+  int    numThreads = 1;
+  size_t chunkSize  = 1<<22;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+
+    if      (arg == "-format" && i < argc - 1) {
+      std::string name = argv[++i];
+
+      if      (name == "hex" ) format = Format::HEX;
+      else if (name == "rgb" ) format = Format::RGB;
+      else if (name == "hsl" ) format = Format::HSL;
+      else if (name == "cmyk") format = Format::CMYK;
+      else {
+        std::cerr << "Invalid format '" << name << "'" << std::endl;
+        return 2;
+      }
+    }
+    else if (arg == "-threads" && i < argc - 1)
+      numThreads = CQColorPalette::numThreads(atoi(argv[++i]));
+    else if (arg == "-chunk" && i < argc - 1)
+      chunkSize = size_t(std::max(atol(argv[++i]), 1024L));
+    else {
+      std::cerr << "Usage: CQColorConvert [-format hex|rgb|hsl|cmyk] "
+                   "[-threads <n>] [-chunk <bytes>]" << std::endl;
+      return 2;
+    }
+  }
+
+  //---
+
+  std::vector<char> buffer(chunkSize);
+
+  std::vector<std::string> outs(numThreads);
+
+  size_t used       = 0; // bytes in buffer (partial line carried to next chunk)
+  long   numInvalid = 0;
+  bool   eof        = false;
+
+  while (! eof) {
+    size_t n = fread(&buffer[used], 1, buffer.size() - used, stdin);
+
+    used += n;
+
+    eof = (n == 0 || feof(stdin));
+
+    // terminate last line
+    if (eof && used > 0 && buffer[used - 1] != '\n') {
+      if (used == buffer.size())
+        buffer.resize(buffer.size() + 1);
+
+      buffer[used++] = '\n';
+    }
+
+    // find end of complete lines
+    size_t end = used;
+
+    while (end > 0 && buffer[end - 1] != '\n')
+      --end;
+
+    if (end == 0) {
+      // line longer than chunk
+      if (used == buffer.size())
+        buffer.resize(buffer.size()*2);
+
+      continue;
+    }
+
+    //---
+
+    const char *start = &buffer[0];
+
+    if (numThreads <= 1) {
+      outs[0].clear();
+
+      numInvalid += convertLines(start, start + end, format, outs[0]);
+
+      fwrite(outs[0].data(), 1, outs[0].size(), stdout);
+    }
+    else {
+      // split into bands of complete lines
+      std::vector<const char *> bands;
+
+      bands.push_back(start);
+
+      for (int i = 1; i < numThreads; ++i) {
+        const char *p = std::max(start + end*i/numThreads, bands.back());
+
+        auto *eol = static_cast<const char *>(memchr(p, '\n', size_t(start + end - p)));
+
+        bands.push_back(eol ? eol + 1 : start + end);
+      }
+
+      bands.push_back(start + end);
+
+      std::atomic<long> numInvalid1 { 0 };
+
+      std::vector<std::thread> threads;
+
+      for (int i = 0; i < numThreads; ++i) {
+        threads.emplace_back([&, i]() {
+          outs[i].clear();
+
+          numInvalid1 += convertLines(bands[i], bands[i + 1], format, outs[i]);
+        });
+      }
+
+      for (auto &thread : threads)
+        thread.join();
+
+      numInvalid += numInvalid1;
+
+      for (const auto &out : outs)
+        fwrite(out.data(), 1, out.size(), stdout);
+    }
+
+    // move partial line to start
+    memmove(&buffer[0], &buffer[end], used - end);
+
+    used -= end;
+  }
+
+  fflush(stdout);
+
+  if (numInvalid > 0) {
+    std::cerr << numInvalid << " invalid colors" << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,26 @@
+TEMPLATE = app
+
+TARGET = CQColorConvert
+
+DEPENDPATH += .
+
+QT += widgets network
+
+CONFIG += console
+CONFIG -= app_bundle
+
+QMAKE_CXXFLAGS += -std=c++14
+
+SOURCES += \
+CQColorConvert.cpp \
+
+DESTDIR     = .
+OBJECTS_DIR = .
+
+INCLUDEPATH += \
+../../include \
+.
+
+unix:LIBS += \
+-L../../lib \
+-lCQColorSelector
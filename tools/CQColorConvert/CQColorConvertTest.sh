@@ -0,0 +1,209 @@
+#!/bin/sh
+#
+# Check CQColorConvert output for known input colors in each format and check the
+# output does not depend on the number of threads or the chunk size.
+#
+#   CQColorConvertTest.sh [<CQColorConvert>]
+#
+# Exit status is 1 if any check failed.
+
+convert=${1:-$(dirname "$0")/CQColorConvert}
+
+tmp=$(mktemp -d) || exit 1
+
+trap 'rm -rf "$tmp"' EXIT
+
+failed=0
+
+# convert input in format ($1) and compare with expected lines (stdin)
+check() {
+  cat > "$tmp/expected"
+
+  "$convert" -format "$1" < "$tmp/input" > "$tmp/output" 2> /dev/null
+
+  if ! cmp -s "$tmp/expected" "$tmp/output"; then
+    echo "FAIL: -format $1"
+    diff "$tmp/expected" "$tmp/output"
+    failed=1
+  fi
+}
+
+#---
+
+# hex, names, CSS functions (comma, space and slash separated, percent, deg,
+# out of range values), invalid colors, empty and CRLF lines
+cat > "$tmp/input" <<'END'
+#f00
+#F008
+#00ff80
+#0080ff40
+red
+  blue  
+rgb(0, 128, 255)
+rgba(0,128,255,0.5)
+RGB( 100% 50% 0% )
+rgb(0 0 255 / 25%)
+rgb(300, -20, 0)
+hsl(0, 100%, 50%)
+hsl(120deg 100% 25%)
+hsla(240, 100%, 50%, 0.5)
+hsl(-120 100% 50%)
+hsl(480deg 100% 50% / 50%)
+cmyk(0%, 100%, 100%, 0%)
+cmyk(1 0 1 0)
+
+rgb(0, 0, 255
+hsl(0 100%)
+rgb(0, 0, 255) x
+#12345
+notacolor
+END
+
+printf '#00ff00\r\nrgb(0 128 255)\r\n' >> "$tmp/input"
+
+check hex <<'END'
+#ff0000
+#ff000088
+#00ff80
+#0080ff40
+#ff0000
+#0000ff
+#0080ff
+#0080ff80
+#ff8000
+#0000ff40
+#ff0000
+#ff0000
+#008000
+#0000ff80
+#0000ff
+#00ff0080
+#ff0000
+#00ff00
+
+
+
+
+
+
+#00ff00
+#0080ff
+END
+
+check rgb <<'END'
+rgb(255, 0, 0)
+rgba(255, 0, 0, 0.533)
+rgb(0, 255, 128)
+rgba(0, 128, 255, 0.251)
+rgb(255, 0, 0)
+rgb(0, 0, 255)
+rgb(0, 128, 255)
+rgba(0, 128, 255, 0.502)
+rgb(255, 128, 0)
+rgba(0, 0, 255, 0.251)
+rgb(255, 0, 0)
+rgb(255, 0, 0)
+rgb(0, 128, 0)
+rgba(0, 0, 255, 0.502)
+rgb(0, 0, 255)
+rgba(0, 255, 0, 0.502)
+rgb(255, 0, 0)
+rgb(0, 255, 0)
+
+
+
+
+
+
+rgb(0, 255, 0)
+rgb(0, 128, 255)
+END
+
+check hsl <<'END'
+hsl(0, 100%, 50%)
+hsla(0, 100%, 50%, 0.533)
+hsl(150, 100%, 50%)
+hsla(210, 100%, 50%, 0.251)
+hsl(0, 100%, 50%)
+hsl(240, 100%, 50%)
+hsl(210, 100%, 50%)
+hsla(210, 100%, 50%, 0.502)
+hsl(30, 100%, 50%)
+hsla(240, 100%, 50%, 0.251)
+hsl(0, 100%, 50%)
+hsl(0, 100%, 50%)
+hsl(120, 100%, 25%)
+hsla(240, 100%, 50%, 0.502)
+hsl(240, 100%, 50%)
+hsla(120, 100%, 50%, 0.502)
+hsl(0, 100%, 50%)
+hsl(120, 100%, 50%)
+
+
+
+
+
+
+hsl(120, 100%, 50%)
+hsl(210, 100%, 50%)
+END
+
+check cmyk <<'END'
+cmyk(0%, 100%, 100%, 0%)
+cmyk(0%, 100%, 100%, 0%, 0.533)
+cmyk(100%, 0%, 50%, 0%)
+cmyk(100%, 50%, 0%, 0%, 0.251)
+cmyk(0%, 100%, 100%, 0%)
+cmyk(100%, 100%, 0%, 0%)
+cmyk(100%, 50%, 0%, 0%)
+cmyk(100%, 50%, 0%, 0%, 0.502)
+cmyk(0%, 50%, 100%, 0%)
+cmyk(100%, 100%, 0%, 0%, 0.251)
+cmyk(0%, 100%, 100%, 0%)
+cmyk(0%, 100%, 100%, 0%)
+cmyk(100%, 0%, 100%, 50%)
+cmyk(100%, 100%, 0%, 0%, 0.502)
+cmyk(100%, 100%, 0%, 0%)
+cmyk(100%, 0%, 100%, 0%, 0.502)
+cmyk(0%, 100%, 100%, 0%)
+cmyk(100%, 0%, 100%, 0%)
+
+
+
+
+
+
+cmyk(100%, 0%, 100%, 0%)
+cmyk(100%, 50%, 0%, 0%)
+END
+
+#---
+
+# repeat input so it is split into many chunks and thread bands, output (and exit
+# status for invalid colors) must match single threaded conversion
+awk '{ line[NR] = $0 } END { for (i = 0; i < 2000; ++i) for (j = 1; j <= NR; ++j) print line[j] }' \
+  "$tmp/input" > "$tmp/big"
+
+for format in hex rgb hsl cmyk; do
+  "$convert" -format $format -threads 1 < "$tmp/big" > "$tmp/ref" 2> /dev/null
+
+  refStatus=$?
+
+  for args in "-threads 2" "-threads 3" "-threads 0" "-threads 1 -chunk 1024" \
+              "-threads 4 -chunk 1024"; do
+    "$convert" -format $format $args < "$tmp/big" > "$tmp/output" 2> /dev/null
+
+    status=$?
+
+    if [ $status -ne $refStatus ] || ! cmp -s "$tmp/ref" "$tmp/output"; then
+      echo "FAIL: -format $format $args differs from -threads 1"
+      failed=1
+    fi
+  done
+done
+
+if [ $failed -eq 0 ]; then
+  echo "ok"
+fi
+
+exit $failed